@@ -0,0 +1,224 @@
+#include "BallField.h"
+#include <algorithm>
+
+void BallField::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_movement_x.clear();
+    m_movement_y.clear();
+    m_rotation.clear();
+    m_half_width.clear();
+    m_half_height.clear();
+    m_sprite.clear();
+    m_order.clear();
+}
+
+void BallField::add(const glm::vec3 &position, const glm::vec3 &movement, float rotation, int sprite)
+{
+    m_x.push_back(position.x);
+    m_y.push_back(position.y);
+    m_movement_x.push_back(movement.x);
+    m_movement_y.push_back(movement.y);
+    m_rotation.push_back(rotation);
+    m_half_width.push_back(BALLS_WIDTH[sprite] / 2);
+    m_half_height.push_back(BALLS_HEIGHT[sprite] / 2);
+    m_sprite.push_back((unsigned char) sprite);
+}
+
+void BallField::serve(int count, unsigned int seed)
+{
+    clear();
+    m_misses = 0;
+
+    // PongSim's own serve, so speeds come out the same way a game's do
+    PongSim sim;
+    unsigned int random_state = seed == 0 ? 1 : seed;
+    for (int i = 0; i < count; i += MAX_BALLS) {
+        sim.reset(seed + i, TWO, MAX_BALLS);
+        const PongState &state = sim.get_state();
+        for (int j = 0; j < MAX_BALLS && i + j < count; j++) {
+            float x = (PongSim::next_random(&random_state) % 10000 / 5000.0f - 1.0f) * (WIDTH_BOUND - PADDLE_WIDTH);
+            float y = (PongSim::next_random(&random_state) % 10000 / 5000.0f - 1.0f) * (HEIGHT_BOUND - BALLS_HEIGHT[j]);
+            add(glm::vec3(x, y, 0.0f), state.balls_movement[j], 0.0f, j);
+        }
+    }
+}
+
+void BallField::copy_from(const PongState &state)
+{
+    clear();
+    for (int i = 0; i < state.ball_number; i++)
+        add(state.balls_position[i], state.balls_movement[i], state.balls_rotation[i].z, i);
+}
+
+// The balls' step over raw arrays. The arrays are restrict parameters here,
+// rather than locals in BallField::step, because compilers only reliably take
+// restrict at its word on parameters.
+static int step_balls(float *__restrict x, float *__restrict y,
+                      float *__restrict movement_x, float *__restrict movement_y,
+                      float *__restrict rotation,
+                      const float *__restrict half_width, const float *__restrict half_height,
+                      int size, float delta_time, float paddle_left_y, float paddle_right_y)
+{
+    const float step = BALL_SPEED * delta_time;
+    const float left_face = PADDLE_LEFT_INIT_POS.x + PADDLE_WIDTH / 2;
+    const float right_face = PADDLE_RIGHT_INIT_POS.x - PADDLE_WIDTH / 2;
+
+    // Each test becomes a 0 or 1 mask and each outcome is blended in with it,
+    // so the loop is straight-line arithmetic over unaliased arrays that the
+    // compiler can turn into SIMD. GCC only does so with -fno-trapping-math;
+    // otherwise it will not evaluate what the scalar code might have skipped.
+    int misses = 0;
+    for (int i = 0; i < size; i++) {
+        float previous_x = x[i], previous_y = y[i];
+        float ball_movement_x = movement_x[i], ball_movement_y = movement_y[i];
+        float ball_half_width = half_width[i], ball_half_height = half_height[i];
+
+        float next_x = previous_x + ball_movement_x * step;
+        float next_y = previous_y + ball_movement_y * step;
+        rotation[i] += ROT_INCREMENT * delta_time;
+
+        // up and bottom
+        float hit_top = next_y >= HEIGHT_BOUND ? 1.0f : 0.0f;
+        float hit_bottom = next_y <= -HEIGHT_BOUND ? 1.0f : 0.0f;
+        next_y += hit_top * (HEIGHT_BOUND - ball_half_height - next_y)
+                + hit_bottom * (-HEIGHT_BOUND + ball_half_height - next_y);
+        movement_y[i] = ball_movement_y * (1.0f - 2.0f * (hit_top + hit_bottom));
+
+        // paddles, swept as in PongSim::sweep_paddle; only the one the ball is
+        // heading for can be hit
+        float heading_right = ball_movement_x > 0.0f ? 1.0f : 0.0f;
+        float left_contact = left_face + ball_half_width;
+        float contact = left_contact + heading_right * (right_face - ball_half_width - left_contact);
+        float paddle_y = paddle_left_y + heading_right * (paddle_right_y - paddle_left_y);
+        float paddle_half = PADDLE_LEFT_HEIGHT / 2 + heading_right * (PADDLE_RIGHT_HEIGHT / 2 - PADDLE_LEFT_HEIGHT / 2);
+
+        float before = contact - previous_x, after = next_x - contact;
+        float travelled = next_x - previous_x;
+        float t = before / (travelled + (travelled == 0.0f ? 1.0f : 0.0f));
+        float contact_y = previous_y + (next_y - previous_y) * t;
+
+        // crossed the face this step, and within the paddle where it did
+        float bounced = before * ball_movement_x > 0.0f ? 1.0f : 0.0f;
+        bounced = after * ball_movement_x >= 0.0f ? bounced : 0.0f;
+        bounced = contact_y <= paddle_y + paddle_half ? bounced : 0.0f;
+        bounced = contact_y >= paddle_y - paddle_half ? bounced : 0.0f;
+
+        next_x += bounced * (contact - after - next_x);
+        movement_x[i] = ball_movement_x * (1.0f - 2.0f * bounced);
+
+        // a missed ball goes back to the middle
+        float missed = next_x >= WIDTH_BOUND + 0.5f ? 1.0f : 0.0f;
+        missed = next_x <= -WIDTH_BOUND - 0.5f ? 1.0f : missed;
+        x[i] = next_x * (1.0f - missed);
+        y[i] = next_y * (1.0f - missed);
+        misses += (int) missed;
+    }
+
+    return misses;
+}
+
+void BallField::collide()
+{
+    const int size = get_size();
+
+    // Balls move little in a step, so last step's order is nearly sorted and
+    // an insertion sort fixes it in close to linear time. Missed balls jump
+    // back to the middle, though; if that costs too many moves, sort afresh.
+    if ((int) m_order.size() != size) {
+        m_order.resize(size);
+        for (int i = 0; i < size; i++) m_order[i] = i;
+    }
+    m_left.resize(size);
+    for (int i = 0; i < size; i++) m_left[i] = m_x[i] - m_half_width[i];
+
+    long long moves = 0;
+    const long long move_budget = 8LL * size;
+    for (int i = 1; i < size && moves <= move_budget; i++) {
+        int ball = m_order[i];
+        int j = i - 1;
+        for (; j >= 0 && m_left[m_order[j]] > m_left[ball] && moves <= move_budget; j--, moves++)
+            m_order[j + 1] = m_order[j];
+        m_order[j + 1] = ball;
+    }
+    if (moves > move_budget) {
+        const std::vector<float> &left = m_left;
+        std::sort(m_order.begin(), m_order.end(), [&left](int a, int b) { return left[a] < left[b]; });
+    }
+
+    // Lay the fields the sweep reads out in sorted order, so its inner loop
+    // walks memory in a line instead of jumping around by index
+    m_sorted_left.resize(size);
+    m_sorted_y.resize(size);
+    m_sorted_radius.resize(size);
+    for (int i = 0; i < size; i++) {
+        int ball = m_order[i];
+        m_sorted_left[i] = m_left[ball];
+        m_sorted_y[i] = m_y[ball];
+        m_sorted_radius[i] = m_half_width[ball];
+    }
+
+    const int *order = m_order.data();
+    const float *left = m_sorted_left.data(), *y = m_sorted_y.data();
+    const float *radius = m_sorted_radius.data();
+
+    // Sweep: each ball only needs testing against the balls after it in the
+    // order whose left edge comes before its right edge. Those that are also
+    // close in y are gathered first without branching, since which ones are
+    // is too random for the branch predictor, and then tested in full.
+    //
+    // The sorted copies stay as they were at the start of the sweep, even as
+    // contacts push balls apart, so that the order (and with it the early
+    // exit) holds all the way through. A ball pushed into a new neighbour
+    // meets it next step.
+    m_candidates.resize(size);
+    int *candidates = m_candidates.data();
+
+    int pair_count = 0, contact_count = 0;
+    for (int i = 0; i < size; i++) {
+        float a_right = left[i] + 2 * radius[i];
+
+        int candidate_count = 0;
+        int j = i + 1;
+        for (; j < size && left[j] <= a_right; j++) {
+            float reach = radius[i] + radius[j];
+            float distance_y = y[j] - y[i];
+            candidates[candidate_count] = j;
+            candidate_count += (distance_y <= reach) & (distance_y >= -reach);
+        }
+        pair_count += j - i - 1;
+
+        for (int k = 0; k < candidate_count; k++) {
+            int other = candidates[k];
+            int a = order[i], b = order[other];
+
+            glm::vec2 a_position(m_x[a], m_y[a]), a_movement(m_movement_x[a], m_movement_y[a]);
+            glm::vec2 b_position(m_x[b], m_y[b]), b_movement(m_movement_x[b], m_movement_y[b]);
+            if (!PongSim::collide_balls(&a_position, &a_movement, radius[i],
+                                        &b_position, &b_movement, radius[other])) continue;
+
+            contact_count++;
+            m_x[a] = a_position.x;
+            m_y[a] = a_position.y;
+            m_movement_x[a] = a_movement.x;
+            m_movement_y[a] = a_movement.y;
+            m_x[b] = b_position.x;
+            m_y[b] = b_position.y;
+            m_movement_x[b] = b_movement.x;
+            m_movement_y[b] = b_movement.y;
+        }
+    }
+
+    m_pair_count = pair_count;
+    m_contact_count = contact_count;
+}
+
+void BallField::step(float delta_time, float paddle_left_y, float paddle_right_y)
+{
+    m_misses += step_balls(m_x.data(), m_y.data(), m_movement_x.data(), m_movement_y.data(),
+                           m_rotation.data(), m_half_width.data(), m_half_height.data(),
+                           get_size(), delta_time, paddle_left_y, paddle_right_y);
+
+    if (m_collisions) collide();
+}
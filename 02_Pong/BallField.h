@@ -0,0 +1,58 @@
+#pragma once
+#include <vector>
+#include "PongSim.h"
+
+// Any number of balls, stored as one array per field so the per-step loops
+// run over contiguous floats and the compiler can vectorise them.
+//
+// Normal games copy their one to three balls in from PongState for drawing;
+// the stress mode fills it with as many as it likes and steps them here.
+class BallField
+{
+private:
+    std::vector<float> m_x, m_y;
+    std::vector<float> m_movement_x, m_movement_y;
+    std::vector<float> m_rotation;
+    std::vector<float> m_half_width, m_half_height;
+    std::vector<unsigned char> m_sprite;    // which of the three ball sprites
+
+    int m_misses = 0;                       // balls that got past a paddle, ever
+
+    // ball-versus-ball, sort and sweep along x
+    bool m_collisions = false;
+    std::vector<int> m_order;               // ball indices by the left edge, kept from step to step
+    std::vector<float> m_left;              // each ball's left edge this step
+    std::vector<float> m_sorted_left, m_sorted_y, m_sorted_radius;
+    std::vector<int> m_candidates;
+    int m_pair_count = 0;                   // pairs overlapping in x last step, tested in full
+    int m_contact_count = 0;                // of those, pairs actually touching
+
+    void collide();
+
+public:
+    void clear();
+    void add(const glm::vec3 &position, const glm::vec3 &movement, float rotation, int sprite);
+
+    // Fills the field with count balls scattered over the court at random
+    // speeds, so that they don't all start on top of each other
+    void serve(int count, unsigned int seed);
+
+    // The balls of a normal game, to draw them the same way
+    void copy_from(const PongState &state);
+
+    // One fixed step against the walls, the two paddles and, if turned on,
+    // each other. A missed ball is served again from the middle rather than
+    // ending anything.
+    void step(float delta_time, float paddle_left_y, float paddle_right_y);
+
+    void set_collisions(bool collisions) { m_collisions = collisions; }
+
+    int const get_size() const { return (int) m_x.size(); }
+    int const get_misses() const { return m_misses; }
+    int const get_pair_count() const { return m_pair_count; }
+    int const get_contact_count() const { return m_contact_count; }
+    const float *get_x() const { return m_x.data(); }
+    const float *get_y() const { return m_y.data(); }
+    const float *get_rotation() const { return m_rotation.data(); }
+    const unsigned char *get_sprite() const { return m_sprite.data(); }
+};
@@ -0,0 +1,247 @@
+#include "PongSim.h"
+#include <cmath>
+
+unsigned int PongSim::next_random(unsigned int *random_state)
+{
+    unsigned int x = *random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *random_state = x;
+    return x;
+}
+
+float PongSim::rand_speed(unsigned int *random_state, float min, float max)
+{
+    return min + (next_random(random_state) % static_cast<int>(max - min + 1));
+}
+
+void PongSim::reset(unsigned int seed, GameMode mode, int ball_number)
+{
+    m_state = PongState();
+    m_state.mode = mode;
+    m_state.ball_number = ball_number < 1 ? 1 : (ball_number > MAX_BALLS ? MAX_BALLS : ball_number);
+    m_state.random_state = seed == 0 ? 1 : seed;
+
+    // randomize start speed
+    for (int i = 0; i < MAX_BALLS; i++) {
+        float temp[2];
+        for (int j = 0; j < 2; j++) {
+            if (next_random(&m_state.random_state) % 100 >= 50) {
+                temp[j] = rand_speed(&m_state.random_state, 0.7f, 2.3f);
+            }
+            else {
+                temp[j] = rand_speed(&m_state.random_state, -2.3f, -0.7f);
+            }
+        }
+        m_state.balls_position[i] = glm::vec3(0.0f);
+        m_state.balls_movement[i] = glm::vec3(temp[0], temp[1], 0.0f);
+        m_state.balls_rotation[i] = glm::vec3(0.0f);
+    }
+}
+
+void PongSim::set_mode(GameMode mode)
+{
+    m_state.mode = mode;
+}
+
+void PongSim::set_ball_number(int ball_number)
+{
+    m_state.ball_number = ball_number < 1 ? 1 : (ball_number > MAX_BALLS ? MAX_BALLS : ball_number);
+
+    // balls that leave play start again from the middle when they come back
+    for (int i = m_state.ball_number; i < MAX_BALLS; i++) m_state.balls_position[i] = glm::vec3(0.0f);
+}
+
+bool PongSim::sweep_paddle(const glm::vec3 &previous_position, glm::vec3 *ball_position, glm::vec3 *ball_movement,
+                           float contact_x, float paddle_y, float paddle_height)
+{
+    // only a ball heading into the paddle that crossed its face this step
+    float direction = contact_x - previous_position.x;
+    if (direction * ball_movement->x <= 0.0f) return false;
+    if ((ball_position->x - contact_x) * direction < 0.0f) return false;
+
+    // where the ball's path met the face, not where the step left it
+    float t = (contact_x - previous_position.x) / (ball_position->x - previous_position.x);
+    float contact_y = previous_position.y + (ball_position->y - previous_position.y) * t;
+
+    if (contact_y > paddle_y + paddle_height / 2 || contact_y < paddle_y - paddle_height / 2) return false;
+
+    // bounce, carrying on for whatever is left of the step
+    ball_position->x = contact_x - (ball_position->x - contact_x);
+    ball_movement->x *= -1;
+    return true;
+}
+
+bool PongSim::collide_balls(glm::vec2 *a_position, glm::vec2 *a_movement, float a_radius,
+                            glm::vec2 *b_position, glm::vec2 *b_movement, float b_radius)
+{
+    glm::vec2 between = *b_position - *a_position;
+    float distance_squared = glm::dot(between, between);
+    float touching = a_radius + b_radius;
+    if (distance_squared >= touching * touching) return false;
+
+    // two balls served on top of each other have no line between them; pick one
+    float distance = sqrtf(distance_squared);
+    glm::vec2 normal = distance > 0.0f ? between / distance : glm::vec2(1.0f, 0.0f);
+
+    float overlap = touching - distance;
+    *a_position -= normal * (overlap / 2);
+    *b_position += normal * (overlap / 2);
+
+    float closing = glm::dot(*a_movement - *b_movement, normal);
+    if (closing > 0.0f) {
+        *a_movement -= normal * closing;
+        *b_movement += normal * closing;
+    }
+    return true;
+}
+
+void PongSim::step_paddles(unsigned char left_input, unsigned char right_input)
+{
+    const float delta_time = FIXED_TIMESTEP;
+
+    glm::vec3 paddle_left_movement = glm::vec3(0.0f);
+    glm::vec3 paddle_right_movement = glm::vec3(0.0f);
+
+    if (right_input & PONG_DOWN)    paddle_right_movement.y = -1.0f;
+    else if (right_input & PONG_UP) paddle_right_movement.y = 1.0f;
+
+    if (m_state.mode == TWO) {
+        if (left_input & PONG_UP)        paddle_left_movement.y = 1.0f;
+        else if (left_input & PONG_DOWN) paddle_left_movement.y = -1.0f;
+    }
+
+    // left paddle
+    glm::vec3 &paddle_left_position = m_state.paddle_left_position;
+    if (m_state.mode == ONE) {
+        if (paddle_left_position.y > HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2) {
+            paddle_left_position.y = HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2;
+            m_state.paddle_left_movement_one.y *= -1;
+        }
+        else if (paddle_left_position.y < -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2) {
+            paddle_left_position.y = -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2;
+            m_state.paddle_left_movement_one.y *= -1;
+        }
+        paddle_left_position += m_state.paddle_left_movement_one * PADDLE_SPEED * delta_time;
+    }
+    else {
+        if (paddle_left_position.y >= HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2) {
+            paddle_left_position.y = HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2 - HANGING_OFFSET;
+        }
+        else if (paddle_left_position.y <= -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2) {
+            paddle_left_position.y = -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2 + HANGING_OFFSET;
+        }
+        else {
+            paddle_left_position += paddle_left_movement * PADDLE_SPEED * delta_time;
+        }
+    }
+
+    // right paddle
+    glm::vec3 &paddle_right_position = m_state.paddle_right_position;
+    if (paddle_right_position.y > HEIGHT_BOUND - PADDLE_RIGHT_HEIGHT / 2) {
+        paddle_right_position.y = HEIGHT_BOUND - PADDLE_RIGHT_HEIGHT / 2;
+    }
+    else if (paddle_right_position.y < -HEIGHT_BOUND + PADDLE_RIGHT_HEIGHT / 2) {
+        paddle_right_position.y = -HEIGHT_BOUND + PADDLE_RIGHT_HEIGHT / 2;
+    }
+    else {
+        paddle_right_position += paddle_right_movement * PADDLE_SPEED * delta_time;
+    }
+}
+
+void PongSim::step(unsigned char left_input, unsigned char right_input)
+{
+    if (m_state.is_over) return;
+
+    const float delta_time = FIXED_TIMESTEP;
+
+    step_paddles(left_input, right_input);
+
+    const glm::vec3 &paddle_left_position = m_state.paddle_left_position;
+    const glm::vec3 &paddle_right_position = m_state.paddle_right_position;
+
+    // ball
+    for (int i = 0; i < m_state.ball_number; i++) {
+        glm::vec3 &ball_position = m_state.balls_position[i];
+        glm::vec3 &ball_movement = m_state.balls_movement[i];
+
+        glm::vec3 previous_position = ball_position;
+        ball_position += ball_movement * BALL_SPEED * delta_time;
+        m_state.balls_rotation[i].z += ROT_INCREMENT * delta_time;
+
+        // up and bottom
+        if (ball_position.y >= HEIGHT_BOUND) {
+            ball_position.y = HEIGHT_BOUND - BALLS_HEIGHT[i] / 2;
+            ball_movement.y *= -1;
+        }
+        else if (ball_position.y <= -HEIGHT_BOUND) {
+            ball_position.y = -HEIGHT_BOUND + BALLS_HEIGHT[i] / 2;
+            ball_movement.y *= -1;
+        }
+
+        // paddles, swept along the step so a fast ball cannot pass through one
+        sweep_paddle(previous_position, &ball_position, &ball_movement,
+                     PADDLE_RIGHT_INIT_POS.x - PADDLE_WIDTH / 2 - BALLS_WIDTH[i] / 2,
+                     paddle_right_position.y, PADDLE_RIGHT_HEIGHT);
+        sweep_paddle(previous_position, &ball_position, &ball_movement,
+                     PADDLE_LEFT_INIT_POS.x + PADDLE_WIDTH / 2 + BALLS_WIDTH[i] / 2,
+                     paddle_left_position.y, PADDLE_LEFT_HEIGHT);
+
+        // a ball past a paddle's face has been missed
+        if (ball_position.x >= WIDTH_BOUND + 0.5f) {
+            m_state.is_over = true;
+            m_state.winner = PLAYER1;
+        }
+        else if (ball_position.x <= -WIDTH_BOUND - 0.5f) {
+            m_state.is_over = true;
+            m_state.winner = PLAYER2;
+        }
+    }
+
+    // balls against each other; with three at most there is nothing to prune
+    for (int i = 0; i < m_state.ball_number; i++) {
+        for (int j = i + 1; j < m_state.ball_number; j++) {
+            glm::vec2 a_position = m_state.balls_position[i], a_movement = m_state.balls_movement[i];
+            glm::vec2 b_position = m_state.balls_position[j], b_movement = m_state.balls_movement[j];
+            if (!collide_balls(&a_position, &a_movement, BALLS_WIDTH[i] / 2, &b_position, &b_movement, BALLS_WIDTH[j] / 2)) continue;
+
+            m_state.balls_position[i] = glm::vec3(a_position, 0.0f);
+            m_state.balls_movement[i] = glm::vec3(a_movement, 0.0f);
+            m_state.balls_position[j] = glm::vec3(b_position, 0.0f);
+            m_state.balls_movement[j] = glm::vec3(b_movement, 0.0f);
+        }
+    }
+
+    m_state.frame++;
+}
+
+// FNV-1a, fed a value at a time
+static void hash_bytes(unsigned int *hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++)
+    {
+        *hash ^= bytes[i];
+        *hash *= 16777619u;
+    }
+}
+
+unsigned int const PongSim::checksum() const
+{
+    unsigned int hash = 2166136261u;
+
+    hash_bytes(&hash, &m_state.frame, sizeof(m_state.frame));
+    hash_bytes(&hash, &m_state.is_over, sizeof(m_state.is_over));
+    hash_bytes(&hash, &m_state.winner, sizeof(m_state.winner));
+    hash_bytes(&hash, &m_state.paddle_left_position, sizeof(glm::vec3));
+    hash_bytes(&hash, &m_state.paddle_right_position, sizeof(glm::vec3));
+    hash_bytes(&hash, &m_state.paddle_left_movement_one, sizeof(glm::vec3));
+    for (int i = 0; i < m_state.ball_number; i++) {
+        hash_bytes(&hash, &m_state.balls_position[i], sizeof(glm::vec3));
+        hash_bytes(&hash, &m_state.balls_movement[i], sizeof(glm::vec3));
+        hash_bytes(&hash, &m_state.balls_rotation[i], sizeof(glm::vec3));
+    }
+    hash_bytes(&hash, &m_state.random_state, sizeof(m_state.random_state));
+    return hash;
+}
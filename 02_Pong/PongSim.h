@@ -0,0 +1,106 @@
+#pragma once
+#include "glm/glm.hpp"
+
+enum GameMode {ONE, TWO};
+enum Winner {PLAYER1, PLAYER2};
+
+/* gameplay constants */
+constexpr float WIDTH_BOUND = 4.5f,
+HEIGHT_BOUND = 3.6f;
+
+constexpr float HANGING_OFFSET = 0.01f;
+
+constexpr float PADDLE_WIDTH = 1.0f;
+constexpr float PADDLE_LEFT_HEIGHT = 324 / 157.0f * PADDLE_WIDTH;
+constexpr float PADDLE_RIGHT_HEIGHT = 327 / 141.0f * PADDLE_WIDTH;
+constexpr glm::vec3 PADDLE_LEFT_INIT_POS = glm::vec3(-WIDTH_BOUND, 0.0f, 0.0f);
+constexpr glm::vec3 PADDLE_RIGHT_INIT_POS = glm::vec3(WIDTH_BOUND, 0.0f, 0.0f);
+
+constexpr int MAX_BALLS = 3;
+constexpr float BALLS_WIDTH[MAX_BALLS] = { 0.5f, 0.7f, 0.5f };
+constexpr float BALLS_HEIGHT[MAX_BALLS] = { 720.0f / 851 * BALLS_WIDTH[0], 302 / 400.f * BALLS_WIDTH[1], 210 / 190.f * BALLS_WIDTH[2] };
+constexpr float ROT_INCREMENT = 8.0f;
+
+constexpr float PADDLE_SPEED = 5.0f;
+constexpr float BALL_SPEED = 1.0f;
+
+/* input */
+// One player's input for one step
+enum PongInputBits : unsigned char
+{
+    PONG_UP   = 1 << 0,
+    PONG_DOWN = 1 << 1
+};
+
+/* state */
+// Everything a step reads and writes. Plain data, so saving and restoring it
+// (for rollback) is a copy.
+struct PongState
+{
+    int frame = 0;
+    bool is_over = false;
+    Winner winner = PLAYER1;
+
+    GameMode mode = TWO;
+    int ball_number = 1;
+
+    // paddle offsets from their initial positions
+    glm::vec3 paddle_left_position = glm::vec3(0.0f);
+    glm::vec3 paddle_right_position = glm::vec3(0.0f);
+    glm::vec3 paddle_left_movement_one = glm::vec3(0.0f, 1.0f, 0.0f);  // the computer's paddle in ONE mode
+
+    glm::vec3 balls_position[MAX_BALLS];
+    glm::vec3 balls_movement[MAX_BALLS];
+    glm::vec3 balls_rotation[MAX_BALLS];
+
+    unsigned int random_state = 1;
+};
+
+// Fixed-step Pong.
+//
+// step() advances exactly FIXED_TIMESTEP from the two players' inputs and
+// nothing else: the starting ball speeds come from a seeded generator kept in
+// the state, so two machines that start from the same seed and feed the same
+// inputs stay in lockstep. Balls are swept against the paddles over the whole
+// step, so the outcome does not depend on the frame rate either.
+class PongSim
+{
+private:
+    PongState m_state;
+
+    static float rand_speed(unsigned int *random_state, float min, float max);
+
+    // Bounces a ball whose path this step crossed contact_x (the x its centre
+    // has when touching the paddle's face) within the paddle's height
+    static bool sweep_paddle(const glm::vec3 &previous_position, glm::vec3 *ball_position, glm::vec3 *ball_movement,
+                             float contact_x, float paddle_y, float paddle_height);
+
+public:
+    static constexpr float FIXED_TIMESTEP = 1.0f / 60.0f;
+
+    // xorshift32: the same sequence on every platform, unlike rand()
+    static unsigned int next_random(unsigned int *random_state);
+
+    // Treating both balls as circles, pushes them apart if they overlap and,
+    // if they are closing, swaps their speeds along the line between their
+    // centres (an elastic collision between equal masses). False if they
+    // don't touch.
+    static bool collide_balls(glm::vec2 *a_position, glm::vec2 *a_movement, float a_radius,
+                              glm::vec2 *b_position, glm::vec2 *b_movement, float b_radius);
+
+    void reset(unsigned int seed, GameMode mode = TWO, int ball_number = 1);
+    void step(unsigned char left_input, unsigned char right_input);
+
+    // Just the paddle half of a step, for modes that move their own balls
+    void step_paddles(unsigned char left_input, unsigned char right_input);
+
+    // Changes made between steps, by the local game's menu keys
+    void set_mode(GameMode mode);
+    void set_ball_number(int ball_number);
+
+    // FNV-1a over the state, to check two peers agree
+    unsigned int const checksum() const;
+
+    const PongState &get_state() const { return m_state; }
+    void set_state(const PongState &new_state) { m_state = new_state; }
+};
@@ -0,0 +1,149 @@
+#include "Rollback.h"
+#include <algorithm>
+#include <chrono>
+
+/* packet layout */
+// u32 first frame, u8 input count, that many input bytes, u32 ack (the last
+// frame of the receiver's inputs we hold with no gaps), all little-endian
+static void write_u32(std::vector<unsigned char> *out, int value)
+{
+    for (int i = 0; i < 4; i++) out->push_back((unsigned char) ((unsigned int) value >> (8 * i)));
+}
+
+static int read_u32(const unsigned char *in)
+{
+    unsigned int value = 0;
+    for (int i = 0; i < 4; i++) value |= (unsigned int) in[i] << (8 * i);
+    return (int) value;
+}
+
+RollbackSession::RollbackSession(int local_player, Transport *transport, int input_delay)
+    : m_transport(transport), m_local_player(local_player),
+      m_input_delay(std::min(std::max(input_delay, 0), MAX_INPUT_DELAY)) { }
+
+void RollbackSession::start(unsigned int seed, GameMode mode, int ball_number)
+{
+    m_sim.reset(seed, mode, ball_number);
+    m_stats = RollbackStats();
+    m_frame = 0;
+
+    // Nobody presses anything during the first input_delay frames, so those
+    // inputs are known on both sides from the start
+    for (int player = 0; player < 2; player++)
+        for (int frame = 0; frame < HISTORY; frame++) m_inputs[player][frame] = 0;
+    m_local_through  = m_input_delay - 1;
+    m_remote_through = m_input_delay - 1;
+    m_remote_acked   = m_input_delay - 1;
+}
+
+unsigned char const RollbackSession::predict_remote(int frame) const
+{
+    if (frame <= m_remote_through) return m_inputs[remote_player()][frame % HISTORY];
+    if (m_remote_through < 0) return 0;
+    return m_inputs[remote_player()][m_remote_through % HISTORY];
+}
+
+void RollbackSession::send_inputs()
+{
+    int first = std::max(m_remote_acked + 1, m_local_through - MAX_INPUTS_PER_PACKET + 1);
+    int count = m_local_through - first + 1;
+    if (count <= 0) {
+        first = m_local_through + 1;
+        count = 0;
+    }
+
+    m_packet.clear();
+    write_u32(&m_packet, first);
+    m_packet.push_back((unsigned char) count);
+    for (int frame = first; frame < first + count; frame++)
+        m_packet.push_back(m_inputs[m_local_player][frame % HISTORY]);
+    write_u32(&m_packet, m_remote_through);
+
+    m_transport->send(m_packet);
+}
+
+int RollbackSession::receive_inputs()
+{
+    int rollback_to = m_frame;
+
+    while (m_transport->receive(&m_packet)) {
+        if (m_packet.size() < 5) continue;
+        int first = read_u32(m_packet.data());
+        int count = m_packet[4];
+        if ((int) m_packet.size() != 5 + count + 4) continue;
+
+        m_remote_acked = std::max(m_remote_acked, read_u32(m_packet.data() + 5 + count));
+
+        // Take only what extends the confirmed run; anything after a gap will
+        // be sent again
+        for (int i = 0; i < count; i++) {
+            int frame = first + i;
+            if (frame != m_remote_through + 1) continue;
+
+            unsigned char input = m_packet[5 + i];
+            unsigned char &used = m_inputs[remote_player()][frame % HISTORY];
+
+            // Frames already simulated used a guess; a wrong one means rolling back
+            if (frame < m_frame && used != input) rollback_to = std::min(rollback_to, frame);
+            used = input;
+            m_remote_through = frame;
+        }
+    }
+
+    return rollback_to;
+}
+
+void RollbackSession::simulate_frame(int frame)
+{
+    if (frame > m_remote_through) m_inputs[remote_player()][frame % HISTORY] = predict_remote(frame);
+
+    m_saved[frame % HISTORY] = m_sim.get_state();
+    m_sim.step(m_inputs[0][frame % HISTORY], m_inputs[1][frame % HISTORY]);
+}
+
+void RollbackSession::synchronise()
+{
+    int rollback_to = receive_inputs();
+    if (rollback_to >= m_frame) return;
+
+    auto start = std::chrono::steady_clock::now();
+
+    m_sim.set_state(m_saved[rollback_to % HISTORY]);
+    for (int frame = rollback_to; frame < m_frame; frame++) simulate_frame(frame);
+
+    auto end = std::chrono::steady_clock::now();
+
+    int depth = m_frame - rollback_to;
+    m_stats.rollbacks++;
+    m_stats.resimulated_frames += depth;
+    m_stats.max_rollback = std::max(m_stats.max_rollback, depth);
+    m_stats.resimulation_ms += std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void RollbackSession::poll()
+{
+    synchronise();
+    send_inputs();
+}
+
+bool RollbackSession::advance(unsigned char local_input)
+{
+    synchronise();
+
+    // Too far ahead to keep guessing: wait for the remote, and keep our recent
+    // inputs flowing in case that is what it is waiting for
+    if (m_frame - m_remote_through > MAX_ROLLBACK_FRAMES) {
+        m_stats.stalls++;
+        send_inputs();
+        return false;
+    }
+
+    m_local_through = m_frame + m_input_delay;
+    m_inputs[m_local_player][m_local_through % HISTORY] = local_input;
+    send_inputs();
+
+    simulate_frame(m_frame);
+    m_frame++;
+    m_stats.frames++;
+    return true;
+}
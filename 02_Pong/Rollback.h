@@ -0,0 +1,77 @@
+#pragma once
+#include <vector>
+#include "PongSim.h"
+#include "Transport.h"
+
+struct RollbackStats
+{
+    int frames = 0;                 // frames advanced
+    int stalls = 0;                 // frames we had to wait for the other peer
+    int rollbacks = 0;              // mispredictions corrected
+    int resimulated_frames = 0;
+    int max_rollback = 0;           // deepest correction, in frames
+    double resimulation_ms = 0.0;   // time spent re-running frames
+};
+
+// One peer of a two-player rollback session.
+//
+// Every frame the local input is sent (along with the recent unacknowledged
+// ones, so a lost packet is covered by the next) and the game steps straight
+// away with a guess for the remote input: whatever the remote player last
+// pressed. When the real input for an earlier frame arrives and differs from
+// the guess, the session restores the state saved at that frame and re-runs
+// every frame since with the corrected inputs.
+class RollbackSession
+{
+private:
+    static constexpr int HISTORY = 128;     // frames of inputs and states kept, as a ring
+
+    PongSim m_sim;
+    Transport *m_transport;
+    int m_local_player;                     // 0 plays the left paddle, 1 the right
+    int m_input_delay;
+
+    PongState m_saved[HISTORY];             // state at the start of each frame
+    unsigned char m_inputs[2][HISTORY];     // the input each player used on each frame
+
+    int m_frame = 0;                        // next frame to simulate
+    int m_local_through = -1;               // last frame we have local input for
+    int m_remote_through = -1;              // last frame of remote input received, with no gaps before it
+    int m_remote_acked = -1;                // last frame of ours the remote has confirmed
+
+    RollbackStats m_stats;
+    std::vector<unsigned char> m_packet;
+
+    int const remote_player() const { return 1 - m_local_player; }
+    unsigned char const predict_remote(int frame) const;
+    void send_inputs();
+    int receive_inputs();
+    void simulate_frame(int frame);
+    void synchronise();
+
+public:
+    static constexpr int MAX_ROLLBACK_FRAMES = 12;   // run ahead of the remote by at most this much
+    static constexpr int MAX_INPUT_DELAY = 8;
+    static constexpr int MAX_INPUTS_PER_PACKET = 32;
+
+    RollbackSession(int local_player, Transport *transport, int input_delay = 0);
+
+    // Both peers have to start from the same seed, mode and ball count, and
+    // be constructed with the same input delay
+    void start(unsigned int seed, GameMode mode = TWO, int ball_number = 1);
+
+    // Sends this frame's local input, folds in whatever arrived from the remote
+    // (rolling back if it has to), then steps one frame. Returns false, without
+    // stepping, if we are too far ahead of the remote to guess any further.
+    bool advance(unsigned char local_input);
+
+    // Receives and corrects without stepping, and sends our recent inputs
+    // again, e.g. while waiting for the other peer to catch up
+    void poll();
+
+    const PongSim &get_sim() const { return m_sim; }
+    const RollbackStats &get_stats() const { return m_stats; }
+    int const get_frame() const { return m_frame; }
+    int const get_remote_through() const { return m_remote_through; }
+    int const get_local_player() const { return m_local_player; }
+};
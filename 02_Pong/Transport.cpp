@@ -0,0 +1,50 @@
+#include "Transport.h"
+
+LoopbackLink::LoopbackLink(double latency_ms, float loss_percent, double jitter_ms, unsigned int seed)
+    : m_latency_ms(latency_ms), m_jitter_ms(jitter_ms), m_loss_percent(loss_percent), m_random_state(seed == 0 ? 1 : seed)
+{
+    for (int side = 0; side < 2; side++) {
+        m_endpoints[side].link = this;
+        m_endpoints[side].side = side;
+    }
+}
+
+float LoopbackLink::next_unit_random()
+{
+    // xorshift32, so a given seed drops the same packets every run
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 17;
+    m_random_state ^= m_random_state << 5;
+    return (m_random_state >> 8) / 16777216.0f;
+}
+
+void LoopbackLink::Endpoint::send(const std::vector<unsigned char> &packet)
+{
+    link->m_sent++;
+    if (link->next_unit_random() * 100.0f < link->m_loss_percent) {
+        link->m_dropped++;
+        return;
+    }
+
+    InFlight in_flight;
+    in_flight.deliver_at = link->m_now_ms + link->m_latency_ms + link->next_unit_random() * link->m_jitter_ms;
+    in_flight.bytes = packet;
+    link->m_in_flight[1 - side].push_back(in_flight);
+}
+
+bool LoopbackLink::Endpoint::receive(std::vector<unsigned char> *packet)
+{
+    std::vector<InFlight> &queue = link->m_in_flight[side];
+
+    // Earliest arrival first; with jitter that need not be the order they were sent in
+    int earliest = -1;
+    for (int i = 0; i < (int) queue.size(); i++) {
+        if (queue[i].deliver_at > link->m_now_ms) continue;
+        if (earliest < 0 || queue[i].deliver_at < queue[earliest].deliver_at) earliest = i;
+    }
+    if (earliest < 0) return false;
+
+    packet->swap(queue[earliest].bytes);
+    queue.erase(queue.begin() + earliest);
+    return true;
+}
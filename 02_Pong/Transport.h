@@ -0,0 +1,65 @@
+#pragma once
+#include <vector>
+
+// Moves packets between the two peers of a netplay session. Packets may be
+// dropped, delayed or reordered; the session copes with all three.
+class Transport
+{
+public:
+    virtual ~Transport() { }
+
+    virtual void send(const std::vector<unsigned char> &packet) = 0;
+
+    // Takes the next packet that has arrived; false when there are none
+    virtual bool receive(std::vector<unsigned char> *packet) = 0;
+};
+
+// Two in-process endpoints joined back to back, with artificial one-way latency,
+// jitter and loss for testing. Time is whatever the caller says it is, so a
+// benchmark can run a session far faster than real time.
+class LoopbackLink
+{
+private:
+    struct InFlight
+    {
+        double deliver_at;
+        std::vector<unsigned char> bytes;
+    };
+
+    class Endpoint : public Transport
+    {
+    public:
+        LoopbackLink *link = nullptr;
+        int side = 0;
+
+        void send(const std::vector<unsigned char> &packet) override;
+        bool receive(std::vector<unsigned char> *packet) override;
+    };
+
+    Endpoint m_endpoints[2];
+    std::vector<InFlight> m_in_flight[2];   // packets headed to each side
+
+    double m_now_ms = 0.0;
+    double m_latency_ms;
+    double m_jitter_ms;
+    float  m_loss_percent;
+    unsigned int m_random_state;
+
+    int m_sent    = 0,
+        m_dropped = 0;
+
+    float next_unit_random();
+
+public:
+    LoopbackLink(double latency_ms, float loss_percent, double jitter_ms = 0.0, unsigned int seed = 1);
+
+    Transport *get_endpoint(int side) { return &m_endpoints[side]; }
+
+    void set_time(double now_ms) { m_now_ms = now_ms; }
+    void set_latency(double latency_ms) { m_latency_ms = latency_ms; }
+    void set_loss(float loss_percent) { m_loss_percent = loss_percent; }
+
+    double const get_time() const { return m_now_ms; }
+    int const get_sent_count() const { return m_sent; }
+    int const get_dropped_count() const { return m_dropped; }
+};
@@ -0,0 +1,77 @@
+//
+//  ball_bench.cpp
+//  02_Pong
+//
+//  Times BallField::step, the stress mode's ball update, at a range of ball
+//  counts, with the paddles sweeping up and down so some balls bounce and
+//  some are missed. Then does the same with ball-versus-ball collisions on,
+//  counting the pairs the sort and sweep left to test against every pair
+//  there is.
+//
+//  Usage: ball_bench [steps]
+//
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include "BallField.h"
+
+struct Result
+{
+    double step_ms = 0.0;
+    double pairs = 0.0;         // per step
+    double contacts = 0.0;      // per step
+    int misses = 0;
+};
+
+Result run(int count, int step_count, bool collisions)
+{
+    BallField balls;
+    balls.serve(count, 1);
+    balls.set_collisions(collisions);
+
+    Result result;
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < step_count; step++) {
+        float paddle_y = 2.0f * sinf(step * 0.05f);
+        balls.step(PongSim::FIXED_TIMESTEP, paddle_y, -paddle_y);
+        result.pairs += balls.get_pair_count();
+        result.contacts += balls.get_contact_count();
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    result.step_ms = elapsed_ms / step_count;
+    result.pairs /= step_count;
+    result.contacts /= step_count;
+    result.misses = balls.get_misses();
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    int step_count = argc > 1 ? atoi(argv[1]) : 600;
+
+    const int counts[] = { 1000, 10000, 100000, 1000000 };
+    const int collision_counts[] = { 250, 500, 1000, 2000, 4000, 8000, 16000 };
+
+    printf("%d steps per run\n\n", step_count);
+    printf("   balls  ms/step  ns/ball  misses\n");
+    for (int count : counts) {
+        Result result = run(count, step_count, false);
+        printf("%8d  %7.3f  %7.2f  %6d\n", count, result.step_ms, 1e6 * result.step_ms / count, result.misses);
+    }
+
+    // The court is fixed, so more balls also means more crowded: pairs per
+    // ball grow with the count however good the pruning is
+    printf("\nwith collisions\n");
+    printf("   balls  ms/step  pairs/step  pairs/ball  contacts/step  of all pairs\n");
+    for (int count : collision_counts) {
+        Result result = run(count, step_count, true);
+        double all_pairs = 0.5 * count * (count - 1.0);
+        printf("%8d  %7.3f  %10.0f  %10.1f  %13.0f  %11.3f%%\n", count, result.step_ms, result.pairs,
+               result.pairs / count, result.contacts, 100.0 * result.pairs / all_pairs);
+    }
+
+    return 0;
+}
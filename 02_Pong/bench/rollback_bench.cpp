@@ -0,0 +1,124 @@
+//
+//  rollback_bench.cpp
+//  02_Pong
+//
+//  Plays two rollback peers against each other over a LoopbackLink at a range
+//  of latencies, with each paddle steered by a bot that chases the ball it
+//  sees. Reports how often each peer had to roll back and what resimulation
+//  cost per frame, and checks that both peers end on the same state as a plain
+//  run of the inputs they actually used.
+//
+//  Usage: rollback_bench [frames] [loss_percent] [input_delay]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "PongSim.h"
+#include "Rollback.h"
+#include "Transport.h"
+
+constexpr double FRAME_MS = 1000.0 / 60.0;
+
+// What a player watching their own screen would press
+unsigned char chase_ball(const PongState &state, int player)
+{
+    float paddle_y = player == 0 ? state.paddle_left_position.y : state.paddle_right_position.y;
+    float ball_y   = state.balls_position[0].y;
+
+    if (ball_y > paddle_y + 0.2f) return PONG_UP;
+    if (ball_y < paddle_y - 0.2f) return PONG_DOWN;
+    return 0;
+}
+
+struct Result
+{
+    RollbackStats stats[2];
+    double step_ms = 0.0;
+    int ticks = 0;
+    int dropped = 0;
+    bool in_sync = false;
+};
+
+Result run(int frame_count, double latency_ms, float loss_percent, int input_delay)
+{
+    const unsigned int seed = 1234;
+
+    LoopbackLink link(latency_ms, loss_percent, latency_ms * 0.1, seed);
+    RollbackSession peers[2] = {
+        RollbackSession(0, link.get_endpoint(0), input_delay),
+        RollbackSession(1, link.get_endpoint(1), input_delay)
+    };
+    for (RollbackSession &peer : peers) peer.start(seed);
+
+    // The inputs each player really pressed, by the frame they land on
+    std::vector<unsigned char> pressed[2];
+    for (int player = 0; player < 2; player++) pressed[player].assign(frame_count + input_delay, 0);
+
+    Result result;
+    while (peers[0].get_frame() < frame_count || peers[1].get_frame() < frame_count) {
+        link.set_time(result.ticks * FRAME_MS);
+        for (int player = 0; player < 2; player++) {
+            RollbackSession &peer = peers[player];
+            if (peer.get_frame() >= frame_count) {
+                peer.poll();
+                continue;
+            }
+
+            int frame = peer.get_frame();
+            unsigned char input = chase_ball(peer.get_sim().get_state(), player);
+            if (peer.advance(input)) pressed[player][frame + input_delay] = input;
+        }
+        result.ticks++;
+    }
+
+    // Let the last inputs arrive so that nothing is a guess any more
+    while (peers[0].get_remote_through() < frame_count - 1 || peers[1].get_remote_through() < frame_count - 1) {
+        link.set_time(result.ticks * FRAME_MS);
+        for (RollbackSession &peer : peers) peer.poll();
+        result.ticks++;
+    }
+
+    // A plain run of the same inputs, timed for comparison
+    PongSim reference;
+    reference.reset(seed);
+    auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < frame_count; frame++) reference.step(pressed[0][frame], pressed[1][frame]);
+    result.step_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / frame_count;
+
+    result.in_sync = true;
+    for (int player = 0; player < 2; player++) {
+        result.in_sync = result.in_sync && reference.checksum() == peers[player].get_sim().checksum();
+        result.stats[player] = peers[player].get_stats();
+    }
+    result.dropped = link.get_dropped_count();
+    return result;
+}
+
+int main(int argc, char* argv[])
+{
+    int frame_count    = argc > 1 ? atoi(argv[1]) : 6000;
+    float loss_percent = argc > 2 ? (float) atof(argv[2]) : 0.0f;
+    int input_delay    = argc > 3 ? atoi(argv[3]) : 0;
+
+    const double latencies[] = { 0.0, 16.0, 33.0, 50.0, 100.0, 150.0, 200.0 };
+
+    printf("%d frames, %.1f%% loss, %d frame input delay\n", frame_count, loss_percent, input_delay);
+    printf("latency  rollbacks  resim frames  max depth  stalls  resim us/frame  step us  sync\n");
+
+    bool all_in_sync = true;
+    for (double latency : latencies) {
+        Result result = run(frame_count, latency, loss_percent, input_delay);
+
+        // Both peers do the same work on average; report the busier one
+        const RollbackStats &stats = result.stats[0].resimulation_ms >= result.stats[1].resimulation_ms ? result.stats[0] : result.stats[1];
+        printf("%5.0fms  %9d  %12d  %9d  %6d  %14.3f  %7.3f  %s\n", latency,
+               stats.rollbacks, stats.resimulated_frames, stats.max_rollback, stats.stalls,
+               1000.0 * stats.resimulation_ms / stats.frames, 1000.0 * result.step_ms,
+               result.in_sync ? "ok" : "DESYNC");
+        all_in_sync = all_in_sync && result.in_sync;
+    }
+
+    return all_in_sync ? 0 : 2;
+}
@@ -0,0 +1,101 @@
+//
+//  sim_bench.cpp
+//  02_Pong
+//
+//  Runs PongSim headlessly. First fires a single ball straight at a paddle at
+//  increasing speeds and checks it bounces rather than passing through; then
+//  plays many seeded games between two bots that chase the ball, reporting
+//  the cost of a step, and replays one of them to check the result is the same.
+//
+//  Usage: sim_bench [games] [max_frames_per_game]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "PongSim.h"
+
+unsigned char chase_ball(const PongState &state, float paddle_y)
+{
+    float ball_y = state.balls_position[0].y;
+
+    if (ball_y > paddle_y + 0.2f) return PONG_UP;
+    if (ball_y < paddle_y - 0.2f) return PONG_DOWN;
+    return 0;
+}
+
+// True if a ball fired at the right paddle at this many units per second
+// comes back off it
+bool bounces_at(float speed)
+{
+    PongSim sim;
+    sim.reset(1);
+
+    PongState state = sim.get_state();
+    state.balls_position[0] = glm::vec3(0.0f);
+    state.balls_movement[0] = glm::vec3(speed, 0.0f, 0.0f);
+    sim.set_state(state);
+
+    for (int frame = 0; frame < 600; frame++) {
+        sim.step(0, 0);
+        if (sim.get_state().is_over) return false;
+        if (sim.get_state().balls_movement[0].x < 0.0f) return true;
+    }
+    return false;
+}
+
+unsigned int play(unsigned int seed, int max_frames, int *frames)
+{
+    PongSim sim;
+    sim.reset(seed, TWO, 3);
+
+    for (*frames = 0; *frames < max_frames && !sim.get_state().is_over; (*frames)++) {
+        const PongState &state = sim.get_state();
+        sim.step(chase_ball(state, state.paddle_left_position.y), chase_ball(state, state.paddle_right_position.y));
+    }
+    return sim.checksum();
+}
+
+int main(int argc, char* argv[])
+{
+    int game_count = argc > 1 ? atoi(argv[1]) : 2000;
+    int max_frames = argc > 2 ? atoi(argv[2]) : 36000;
+
+    bool ok = true;
+
+    // At 60 steps a second a ball faster than 60 * PADDLE_WIDTH units a second
+    // jumps more than a paddle's width per step; past about 500 it crosses the
+    // whole court in one, which is as fast as one bounce per step can handle
+    printf("speed (units/s)  step travel  bounced\n");
+    for (float speed = 2.0f; speed <= 512.0f; speed *= 4.0f) {
+        bool bounced = bounces_at(speed);
+        printf("%15.0f  %11.2f  %s\n", speed, speed * PongSim::FIXED_TIMESTEP, bounced ? "yes" : "NO");
+        ok = ok && bounced;
+    }
+
+    long long total_frames = 0;
+    unsigned int first_checksum = 0;
+    int first_frames = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int game = 0; game < game_count; game++) {
+        int frames = 0;
+        unsigned int checksum = play(game + 1, max_frames, &frames);
+        if (game == 0) {
+            first_checksum = checksum;
+            first_frames = frames;
+        }
+        total_frames += frames;
+    }
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    int frames = 0;
+    bool repeatable = play(1, max_frames, &frames) == first_checksum && frames == first_frames;
+    ok = ok && repeatable;
+
+    printf("\n%d games, %lld steps, %.1f steps per game\n", game_count, total_frames, (double) total_frames / game_count);
+    printf("%.1f ns per step, %.0f steps per second\n", 1e6 * elapsed_ms / total_frames, total_frames / (elapsed_ms / 1000.0));
+    printf("replay of game 1: %s\n", repeatable ? "same" : "DIFFERENT");
+
+    return ok ? 0 : 2;
+}
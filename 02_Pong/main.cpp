@@ -21,25 +21,28 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include <ctime>
+#include <cstring>
+#include <chrono>
+#include <cmath>
+#include <vector>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
 #include "stb_image.h"
 #include "glm/ext.hpp"
+#include "PongSim.h"
+#include "BallField.h"
+#include "Rollback.h"
+#include "Transport.h"
 
 /* enums */
 enum AppStatus {RUNNING, GAMEOVER, TERMINATED};
-enum GameMode {ONE, TWO};
-enum Winner {PLAYER1, PLAYER2};
 
 /* constants */
 // The size of our literal game window
 constexpr int WINDOW_WIDTH = 640,
 WINDOW_HEIGHT = 480;
 
-constexpr float WIDTH_BOUND = 4.5f,
-HEIGHT_BOUND = 3.6f;
-
 // general
 constexpr float BG_RED = 255 / 255.0f,
 BG_BLUE = 186 / 255.0f,
@@ -53,29 +56,19 @@ VIEWPORT_HEIGHT = WINDOW_HEIGHT;
 
 constexpr float MILLISECONDS_IN_SECOND = 1000.0;
 
-constexpr float HANGING_OFFSET = 0.01f;
-
 // textures
 constexpr char V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
 F_SHADER_PATH[] = "shaders/fragment_textured.glsl";
 
-constexpr float PADDLE_WIDTH = 1.0f;
 constexpr char PADDLE_LEFT_SPRITE_FILEPATH[] = "assets/left.png";
-constexpr float PADDLE_LEFT_HEIGHT = 324 / 157.0f * PADDLE_WIDTH;
 constexpr char PADDLE_RIGHT_SPRITE_FILEPATH[] = "assets/right.png";
-constexpr float PADDLE_RIGHT_HEIGHT = 327 / 141.0f * PADDLE_WIDTH;
 constexpr glm::vec3 PADDLE_LEFT_INIT_SCALE = glm::vec3(PADDLE_WIDTH, PADDLE_LEFT_HEIGHT, 0.0f);
 constexpr glm::vec3 PADDLE_RIGHT_INIT_SCALE = glm::vec3(PADDLE_WIDTH, PADDLE_RIGHT_HEIGHT, 0.0f);
-constexpr glm::vec3 PADDLE_LEFT_INIT_POS = glm::vec3(-WIDTH_BOUND, 0.0f, 0.0f);
-constexpr glm::vec3 PADDLE_RIGHT_INIT_POS = glm::vec3(WIDTH_BOUND, 0.0f, 0.0f);
 constexpr char BALLS_SPRITE_FILEPATH[3][20] = { "assets/bomb.png", "assets/bomb2.png", "assets/bomb3.png" };
-constexpr float BALLS_WIDTH[3] = { 0.5f, 0.7f, 0.5f };
-constexpr float BALLS_HEIGHT[3] = { 720.0f / 851 * BALLS_WIDTH[0], 302 / 400.f * BALLS_WIDTH[1], 210 / 190.f * BALLS_WIDTH[2] };
 constexpr glm::vec3 BALLS_INIT_SCALE[3] = { 
     glm::vec3(BALLS_WIDTH[0], BALLS_HEIGHT[0], 0.0f),
     glm::vec3(BALLS_WIDTH[1], BALLS_HEIGHT[1], 0.0f), 
     glm::vec3(BALLS_WIDTH[2], BALLS_HEIGHT[2], 0.0f) };
-constexpr float ROT_INCREMENT = 8.0f;
 
 constexpr char PLAYER_ONE_SPRITE_FILEPATH[] = "assets/player1.png";
 constexpr char PLAYER_TWO_SPRITE_FILEPATH[] = "assets/player2.png";
@@ -97,6 +90,13 @@ constexpr float WIN_SIGN_SIZE = 5.0f;
 constexpr glm::vec3 WIN_SIGN_INIT_SCALE = glm::vec3(WIN_SIGN_SIZE, WIN_SIGN_SIZE, 0.0f);
 
 
+// stress
+constexpr int STRESS_REPORT_FRAMES = 120;   // frames averaged per timing line
+
+// netplay
+// The session seed both peers start from, so they serve the same balls
+constexpr unsigned int NETPLAY_SEED = 1234;
+
 constexpr int NUMBER_OF_TEXTURES = 1;
 constexpr GLint LEVEL_OF_DETAIL = 0;
 constexpr GLint TEXTURE_BORDER = 0;
@@ -105,12 +105,11 @@ constexpr GLint TEXTURE_BORDER = 0;
 // general
 SDL_Window* g_display_window = nullptr;
 AppStatus g_game_status = RUNNING;
-GameMode g_game_mode = TWO;
 Winner g_game_winner;
 ShaderProgram g_shader_program = ShaderProgram();
 
 float g_previous_tick = 0.0f;
-int g_ball_number = 1;
+float g_accumulator = 0.0f;
 
 // texture
 GLuint g_paddle_left_texture_id,
@@ -123,13 +122,9 @@ g_winner1_texture_id,
 g_winner2_texture_id;
 
 // objects
-float g_paddle_speed = 5.0f;
-float g_ball_speed = 1.0f;
-
 glm::mat4 g_view_matrix,
 g_paddle_left_matrix,
 g_paddle_right_matrix,
-g_balls_matrix[3],
 g_player1_matrix,
 g_player2_matrix,
 g_instr_matrix,
@@ -139,12 +134,30 @@ g_projection_matrix;
 
 glm::vec3 g_paddle_left_position = glm::vec3(0.0f);
 glm::vec3 g_paddle_right_position = glm::vec3(0.0f);
-glm::vec3 g_paddle_left_movement = glm::vec3(0.0f);
-glm::vec3 g_paddle_left_movement_one = glm::vec3(0.0f, 1.0f, 0.0f);
-glm::vec3 g_paddle_right_movement = glm::vec3(0.0f);
-glm::vec3 g_balls_position[3] = { glm::vec3(0.0f) };
-glm::vec3 g_balls_movement[3] = { glm::vec3(0.0f) };
-glm::vec3 g_balls_rotation[3] = { glm::vec3(0.0f) };
+BallField g_balls;
+
+// every ball with the same sprite goes out in one draw call, built here
+std::vector<float> g_ball_vertices[3],
+g_ball_texture_coordinates[3];
+
+// simulation: the game itself runs in fixed steps; the globals above are
+// copied out of it for drawing
+PongSim* g_sim = nullptr;
+unsigned char g_inputs[2] = { 0, 0 };    // left player, right player
+
+// netplay: two rollback peers in this process, joined by a loopback link with
+// artificial latency and loss. Player 1 (W/S) drives peer 0, player 2 (up and
+// down) drives peer 1, and the screen shows peer 0's view of the game.
+bool g_is_netplay = false;
+LoopbackLink* g_link = nullptr;
+RollbackSession* g_peers[2] = { nullptr, nullptr };
+
+// stress: thousands of balls in g_balls, stepped there instead of by g_sim,
+// which only moves the paddles. Nobody loses; missed balls are served again.
+bool g_is_stress = false;
+double g_stress_simulation_ms = 0.0,
+g_stress_render_ms = 0.0;
+int g_stress_frames = 0;
 
 
 GLuint load_texture(const char* filepath) {
@@ -173,10 +186,6 @@ GLuint load_texture(const char* filepath) {
     return textureID;
 }
 
-float rand_speed(float min, float max) {
-    return min + (rand() % static_cast<int>(max - min + 1));
-}
-
 void initialize() {
     // Initialising
     SDL_Init(SDL_INIT_VIDEO);
@@ -209,26 +218,12 @@ void initialize() {
     g_shader_program.load(V_SHADER_PATH, F_SHADER_PATH);
 
     // randomize start speed
-    srand(time(NULL));
-    for (int i = 0; i < 3; i++) {
-        float temp[2];
-        for (int j = 0; j < 2; j++) {
-            if (rand() % 100 >= 50) {
-                temp[j] = rand_speed(0.7, 2.3);
-            }
-            else {
-                temp[j] = rand_speed(-2.3, -0.7);
-            }
-        }
-        g_balls_movement[i] = glm::vec3(temp[0], temp[1], 0.0f);
-    }
+    g_sim = new PongSim();
+    g_sim->reset((unsigned int) time(NULL));
 
     g_view_matrix = glm::mat4(1.0f);
     g_paddle_left_matrix = glm::mat4(1.0f);
     g_paddle_right_matrix = glm::mat4(1.0f);
-    for (int i = 0; i < g_ball_number; i++) {
-        g_balls_matrix[i] = glm::mat4(1.0f);
-    }
     g_player1_matrix = glm::mat4(1.0f);
     g_player2_matrix = glm::mat4(1.0f);
     g_instr_matrix = glm::mat4(1.0f);
@@ -259,9 +254,6 @@ void initialize() {
 }
 
 void process_input() {
-    g_paddle_left_movement = glm::vec3(0.0f);
-    g_paddle_right_movement = glm::vec3(0.0f);
-
     // bounce on the right paddle
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -275,26 +267,27 @@ void process_input() {
             break;
 
         case SDL_KEYDOWN:
+            // netplay fixes the mode and ball count when the session starts
+            if (g_is_netplay) break;
+            if (g_is_stress && event.key.keysym.sym != SDLK_t) break;
+
             switch (event.key.keysym.sym)
             {
                 case SDLK_t:
                     // switch between one and two player mode
-                    if (g_game_mode == ONE) g_game_mode = TWO;
+                    if (g_sim->get_state().mode == ONE) g_sim->set_mode(TWO);
                     else {
-                        g_game_mode = ONE;
+                        g_sim->set_mode(ONE);
                     }
                     break;
                 case SDLK_1:
-                    g_ball_number = 1;
-                    g_balls_position[1] = glm::vec3(0.0f);
-                    g_balls_position[2] = glm::vec3(0.0f);
+                    g_sim->set_ball_number(1);
                     break;
                 case SDLK_2:
-                    g_balls_position[2] = glm::vec3(0.0f);
-                    g_ball_number = 2;
+                    g_sim->set_ball_number(2);
                     break;
                 case SDLK_3:
-                    g_ball_number = 3;
+                    g_sim->set_ball_number(3);
                     break;
 
                 default:
@@ -308,29 +301,62 @@ void process_input() {
 
     const Uint8* key_state = SDL_GetKeyboardState(NULL);
 
+    g_inputs[1] = 0;
     if (key_state[SDL_SCANCODE_DOWN])
     {
-        g_paddle_right_movement.y = -1.0f;
+        g_inputs[1] = PONG_DOWN;
     }
     else if (key_state[SDL_SCANCODE_UP])
     {
-        g_paddle_right_movement.y = 1.0f;
-    }
-    
-    if (g_game_mode == TWO) {
-        if (key_state[SDL_SCANCODE_W])
-        {
-            g_paddle_left_movement.y = 1.0f;
-        }
-        else if (key_state[SDL_SCANCODE_S])
-        {
-            g_paddle_left_movement.y = -1.0f;
-        }
+        g_inputs[1] = PONG_UP;
     }
 
-    if (glm::length(g_paddle_left_movement) > 1.0f)
+    // in one player mode the simulation moves the left paddle itself
+    g_inputs[0] = 0;
+    if (key_state[SDL_SCANCODE_W])
+    {
+        g_inputs[0] = PONG_UP;
+    }
+    else if (key_state[SDL_SCANCODE_S])
     {
-        g_paddle_left_movement = glm::normalize(g_paddle_left_movement);
+        g_inputs[0] = PONG_DOWN;
+    }
+}
+
+void update_matrices() {
+    // model matrix reset
+    g_paddle_left_matrix = glm::mat4(1.0f);
+    g_paddle_right_matrix = glm::mat4(1.0f);
+    g_player1_matrix = glm::mat4(1.0f);
+    g_player2_matrix = glm::mat4(1.0f);
+    g_instr_matrix = glm::mat4(1.0f);
+
+    // transformation (the balls are placed vertex by vertex in draw_balls)
+    g_paddle_left_matrix = glm::translate(g_paddle_left_matrix, PADDLE_LEFT_INIT_POS);
+    g_paddle_left_matrix = glm::translate(g_paddle_left_matrix, g_paddle_left_position);
+    g_paddle_left_matrix = glm::scale(g_paddle_left_matrix, PADDLE_LEFT_INIT_SCALE);
+    g_paddle_right_matrix = glm::translate(g_paddle_right_matrix, PADDLE_RIGHT_INIT_POS);
+    g_paddle_right_matrix = glm::translate(g_paddle_right_matrix, g_paddle_right_position);
+    g_paddle_right_matrix = glm::scale(g_paddle_right_matrix, PADDLE_LEFT_INIT_SCALE);
+
+    g_player1_matrix = glm::translate(g_player1_matrix, PLAYER_ONE_INIT_POS);
+    g_player1_matrix = glm::scale(g_player1_matrix, PLAYER_ONE_INIT_SCALE);
+
+    g_player2_matrix = glm::translate(g_player2_matrix, PLAYER_TWO_INIT_POS);
+    g_player2_matrix = glm::scale(g_player2_matrix, PLAYER_TWO_INIT_SCALE);
+
+    g_instr_matrix = glm::translate(g_instr_matrix, INSTR_INIT_POS);
+    g_instr_matrix = glm::scale(g_instr_matrix, INSTR_INIT_SCALE);
+}
+
+// Copies one peer's view of the game into the globals the renderer reads
+void apply_state(const PongState &state) {
+    g_paddle_left_position = state.paddle_left_position;
+    g_paddle_right_position = state.paddle_right_position;
+    if (!g_is_stress) g_balls.copy_from(state);
+    if (state.is_over) {
+        g_game_status = GAMEOVER;
+        g_game_winner = state.winner;
     }
 }
 
@@ -353,124 +379,40 @@ void update() {
         float delta_time = tick - g_previous_tick;
         g_previous_tick = tick;
 
-        // game logic - accumulators
-        // left paddle
-        if (g_game_mode == ONE) {
-            if (g_paddle_left_position.y > HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2) {
-                g_paddle_left_position.y = HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2;
-                g_paddle_left_movement_one.y *= -1;
-            }
-            else if (g_paddle_left_position.y < -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2) {
-                g_paddle_left_position.y = -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2;
-                g_paddle_left_movement_one.y *= -1;
-            }
-            g_paddle_left_position += g_paddle_left_movement_one * g_paddle_speed * delta_time;
+        delta_time += g_accumulator;
+
+        if (delta_time < PongSim::FIXED_TIMESTEP)
+        {
+            g_accumulator = delta_time;
+            return;
         }
-        else {
-            if (g_paddle_left_position.y >= HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2) {
-                g_paddle_left_position.y = HEIGHT_BOUND - PADDLE_LEFT_HEIGHT / 2 - HANGING_OFFSET;
+
+        auto simulation_start = std::chrono::steady_clock::now();
+
+        while (delta_time >= PongSim::FIXED_TIMESTEP)
+        {
+            if (g_is_stress) {
+                g_sim->step_paddles(g_inputs[0], g_inputs[1]);
+                g_balls.step(PongSim::FIXED_TIMESTEP, g_sim->get_state().paddle_left_position.y,
+                             g_sim->get_state().paddle_right_position.y);
             }
-            else if (g_paddle_left_position.y <= -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2) {
-                g_paddle_left_position.y = -HEIGHT_BOUND + PADDLE_LEFT_HEIGHT / 2 + HANGING_OFFSET;
+            else if (g_is_netplay) {
+                g_link->set_time(SDL_GetTicks());
+                for (int player = 0; player < 2; player++) g_peers[player]->advance(g_inputs[player]);
             }
             else {
-                g_paddle_left_position += g_paddle_left_movement * g_paddle_speed * delta_time;
-            }
-        }
-        // right paddle
-        if (g_paddle_right_position.y > HEIGHT_BOUND - PADDLE_RIGHT_HEIGHT / 2) {
-            g_paddle_right_position.y = HEIGHT_BOUND - PADDLE_RIGHT_HEIGHT / 2;
-        }
-        else if (g_paddle_right_position.y < -HEIGHT_BOUND + PADDLE_RIGHT_HEIGHT / 2) {
-            g_paddle_right_position.y = -HEIGHT_BOUND + PADDLE_RIGHT_HEIGHT / 2;
-        }
-        else {
-            g_paddle_right_position += g_paddle_right_movement * g_paddle_speed * delta_time;
-        }
-        //ball
-        for (int i = 0; i < g_ball_number; i++) {
-            g_balls_position[i] += g_balls_movement[i] * g_ball_speed * delta_time;
-            g_balls_rotation[i].z += ROT_INCREMENT * delta_time;
-
-            // collision detection
-            // up and bottom
-            if (g_balls_position[i].y >= HEIGHT_BOUND) {
-                // put it back to the max position to avoid hanging
-                g_balls_position[i].y = HEIGHT_BOUND - BALLS_HEIGHT[i] / 2;
-                g_balls_movement[i].y *= -1;
-            }
-            else if (g_balls_position[i].y <= -HEIGHT_BOUND) {
-                g_balls_position[i].y = -HEIGHT_BOUND + BALLS_HEIGHT[i] / 2;
-                g_balls_movement[i].y *= -1;
-            }
-            // right side
-            if (g_balls_position[i].x >= PADDLE_RIGHT_INIT_POS.x - PADDLE_WIDTH / 2) {
-                // bounce on the right paddle
-                if (g_balls_position[i].y <= g_paddle_right_position.y + PADDLE_RIGHT_HEIGHT / 2 &&
-                    g_balls_position[i].y >= g_paddle_right_position.y - PADDLE_RIGHT_HEIGHT / 2) {
-                    // put the ball back on the paddle   
-                    g_balls_position[i].x = PADDLE_RIGHT_INIT_POS.x - PADDLE_WIDTH / 2 - BALLS_WIDTH[i] / 2;
-                    g_balls_movement[i].x *= -1;
-                }
-                // right player lose
-                else if (g_balls_position[i].x >= WIDTH_BOUND+0.5f) {
-                    g_game_status = GAMEOVER;
-                    g_game_winner = PLAYER1;
-                }
-
+                g_sim->step(g_inputs[0], g_inputs[1]);
             }
-            // left side
-            if (g_balls_position[i].x <= PADDLE_LEFT_INIT_POS.x + PADDLE_WIDTH / 2) {
-                // bounce on the left paddle
-                if (g_balls_position[i].y <= g_paddle_left_position.y + PADDLE_LEFT_HEIGHT / 2 &&
-                    g_balls_position[i].y >= g_paddle_left_position.y - PADDLE_LEFT_HEIGHT / 2) {
-                    g_balls_position[i].x = PADDLE_LEFT_INIT_POS.x + PADDLE_WIDTH / 2 + BALLS_WIDTH[i] / 2;
-                    g_balls_movement[i].x *= -1;
-                }
-                // left player lose
-                else if (g_balls_position[i].x <= -WIDTH_BOUND-0.5f) {
-                    g_game_status = GAMEOVER;
-                    g_game_winner = PLAYER2;
-                }
 
-            }
-
-        }
-
-        // model matrix reset
-        g_paddle_left_matrix = glm::mat4(1.0f);
-        g_paddle_right_matrix = glm::mat4(1.0f);
-        for (int i = 0; i < g_ball_number; i++) {
-            g_balls_matrix[i] = glm::mat4(1.0f);
-
-        }
-        g_player1_matrix = glm::mat4(1.0f);
-        g_player2_matrix = glm::mat4(1.0f);
-        g_instr_matrix = glm::mat4(1.0f);
-
-        // transformation
-        for (int i = 0; i < g_ball_number; i++) {
-            g_balls_matrix[i] = glm::translate(g_balls_matrix[i], g_balls_position[i]);
-            if (i != 1) {
-                g_balls_matrix[i] = glm::rotate(g_balls_matrix[i], g_balls_rotation[i].z, glm::vec3(0.0f, 0.0f, 1.0f));
-            }
-            g_balls_matrix[i] = glm::scale(g_balls_matrix[i], BALLS_INIT_SCALE[i]);
+            delta_time -= PongSim::FIXED_TIMESTEP;
         }
-        g_paddle_left_matrix = glm::translate(g_paddle_left_matrix, PADDLE_LEFT_INIT_POS);
-        g_paddle_left_matrix = glm::translate(g_paddle_left_matrix, g_paddle_left_position);
-        g_paddle_left_matrix = glm::scale(g_paddle_left_matrix, PADDLE_LEFT_INIT_SCALE);
-        g_paddle_right_matrix = glm::translate(g_paddle_right_matrix, PADDLE_RIGHT_INIT_POS);
-        g_paddle_right_matrix = glm::translate(g_paddle_right_matrix, g_paddle_right_position);
-        g_paddle_right_matrix = glm::scale(g_paddle_right_matrix, PADDLE_LEFT_INIT_SCALE);
 
-        g_player1_matrix = glm::translate(g_player1_matrix, PLAYER_ONE_INIT_POS);
-        g_player1_matrix = glm::scale(g_player1_matrix, PLAYER_ONE_INIT_SCALE);
+        g_accumulator = delta_time;
 
-        g_player2_matrix = glm::translate(g_player2_matrix, PLAYER_TWO_INIT_POS);
-        g_player2_matrix = glm::scale(g_player2_matrix, PLAYER_TWO_INIT_SCALE);
+        g_stress_simulation_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - simulation_start).count();
 
-        g_instr_matrix = glm::translate(g_instr_matrix, INSTR_INIT_POS);
-        g_instr_matrix = glm::scale(g_instr_matrix, INSTR_INIT_SCALE);
+        apply_state(g_is_netplay ? g_peers[0]->get_sim().get_state() : g_sim->get_state());
+        update_matrices();
 
     }
 
@@ -482,7 +424,51 @@ void draw_object(glm::mat4& object_g_model_matrix, GLuint& object_texture_id) {
     glDrawArrays(GL_TRIANGLES, 0, 6);
 }
 
+// Writes every ball into one vertex array per sprite, already rotated, scaled
+// and placed, and draws each array with a single call
+void draw_balls() {
+    // the quad's corners, in the same order as render's vertices
+    const float CORNERS[12] = { -0.5f, -0.5f, 0.5f, -0.5f, 0.5f, 0.5f, -0.5f, -0.5f, 0.5f, 0.5f, -0.5f, 0.5f };
+    const float TEXTURE_CORNERS[12] = { 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 0.0f, 0.0f };
+
+    for (int sprite = 0; sprite < 3; sprite++) {
+        g_ball_vertices[sprite].clear();
+        g_ball_texture_coordinates[sprite].clear();
+    }
+
+    const float *x = g_balls.get_x(), *y = g_balls.get_y(), *rotation = g_balls.get_rotation();
+    const unsigned char *sprites = g_balls.get_sprite();
+    for (int i = 0; i < g_balls.get_size(); i++) {
+        int sprite = sprites[i];
+
+        // the second bomb doesn't spin
+        float angle = sprite == 1 ? 0.0f : rotation[i];
+        float cos_angle = cosf(angle), sin_angle = sinf(angle);
+
+        std::vector<float> &vertices = g_ball_vertices[sprite];
+        for (int corner = 0; corner < 6; corner++) {
+            float corner_x = CORNERS[corner * 2] * BALLS_INIT_SCALE[sprite].x;
+            float corner_y = CORNERS[corner * 2 + 1] * BALLS_INIT_SCALE[sprite].y;
+            vertices.push_back(x[i] + cos_angle * corner_x - sin_angle * corner_y);
+            vertices.push_back(y[i] + sin_angle * corner_x + cos_angle * corner_y);
+        }
+        g_ball_texture_coordinates[sprite].insert(g_ball_texture_coordinates[sprite].end(), TEXTURE_CORNERS, TEXTURE_CORNERS + 12);
+    }
+
+    g_shader_program.set_model_matrix(glm::mat4(1.0f));
+    for (int sprite = 0; sprite < 3; sprite++) {
+        if (g_ball_vertices[sprite].empty()) continue;
+
+        glVertexAttribPointer(g_shader_program.get_position_attribute(), 2, GL_FLOAT, false, 0, g_ball_vertices[sprite].data());
+        glVertexAttribPointer(g_shader_program.get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, g_ball_texture_coordinates[sprite].data());
+        glBindTexture(GL_TEXTURE_2D, g_balls_texture_id[sprite]);
+        glDrawArrays(GL_TRIANGLES, 0, (GLsizei) (g_ball_vertices[sprite].size() / 2));
+    }
+}
+
 void render() {
+    auto render_start = std::chrono::steady_clock::now();
+
     // Quite simply: clear the space in memory holding our colours
     glClear(GL_COLOR_BUFFER_BIT);
 
@@ -513,10 +499,7 @@ void render() {
         draw_object(g_player1_matrix, g_player1_texture_id);
         draw_object(g_player2_matrix, g_player2_texture_id);
         draw_object(g_instr_matrix, g_instr_texture_id);
-        for (int i = 0; i < g_ball_number; i++) {
-            draw_object(g_balls_matrix[i], g_balls_texture_id[i]);
-
-        }
+        draw_balls();
 
     }
     else if (g_game_status == GAMEOVER) {
@@ -529,16 +512,67 @@ void render() {
     glDisableVertexAttribArray(g_shader_program.get_position_attribute());
     glDisableVertexAttribArray(g_shader_program.get_tex_coordinate_attribute());
 
+    // building and submitting the frame; the swap below mostly waits for vsync
+    g_stress_render_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - render_start).count();
+
     // Update a window with whatever OpenGL is rendering
     SDL_GL_SwapWindow(g_display_window);
+
+    if (g_is_stress && ++g_stress_frames == STRESS_REPORT_FRAMES) {
+        LOG(g_balls.get_size() << " balls: simulation " << g_stress_simulation_ms / g_stress_frames
+            << " ms/frame, render " << g_stress_render_ms / g_stress_frames << " ms/frame, "
+            << g_balls.get_misses() << " missed so far, " << g_balls.get_pair_count() << " pairs tested and "
+            << g_balls.get_contact_count() << " touching in the last step");
+        g_stress_simulation_ms = 0.0;
+        g_stress_render_ms = 0.0;
+        g_stress_frames = 0;
+    }
 }
 
-void shutdown() { SDL_Quit(); }
+void shutdown() {
+    if (g_is_netplay) {
+        for (int player = 0; player < 2; player++) {
+            const RollbackStats &stats = g_peers[player]->get_stats();
+            LOG("peer " << player << ": " << stats.frames << " frames, " << stats.rollbacks << " rollbacks, "
+                << stats.resimulated_frames << " frames resimulated (deepest " << stats.max_rollback << "), "
+                << stats.stalls << " stalls, " << stats.resimulation_ms << " ms resimulating");
+        }
+        LOG(g_link->get_dropped_count() << " of " << g_link->get_sent_count() << " packets dropped");
+
+        delete g_peers[0];
+        delete g_peers[1];
+        delete g_link;
+    }
+
+    delete g_sim;
+    SDL_Quit();
+}
 
 int main(int argc, char* argv[])
 {
     initialize();
 
+    // --netplay <latency_ms> [loss_percent] [input_delay]
+    if (argc > 2 && strcmp(argv[1], "--netplay") == 0) {
+        int input_delay = argc > 4 ? atoi(argv[4]) : 0;
+
+        g_is_netplay = true;
+        g_link = new LoopbackLink(atof(argv[2]), argc > 3 ? (float) atof(argv[3]) : 0.0f);
+        for (int player = 0; player < 2; player++) {
+            g_peers[player] = new RollbackSession(player, g_link->get_endpoint(player), input_delay);
+            g_peers[player]->start(NETPLAY_SEED);
+        }
+    }
+
+    // --stress <ball_count> [collide]
+    if (argc > 2 && strcmp(argv[1], "--stress") == 0) {
+        g_is_stress = true;
+        g_balls.serve(atoi(argv[2]), (unsigned int) time(NULL));
+        g_balls.set_collisions(argc > 3 && strcmp(argv[3], "collide") == 0);
+    }
+
+    apply_state(g_is_netplay ? g_peers[0]->get_sim().get_state() : g_sim->get_state());
+
     while (g_game_status == RUNNING || g_game_status == GAMEOVER)
     {
         process_input();
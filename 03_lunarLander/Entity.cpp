@@ -15,25 +15,24 @@
 
 // Default constructor
 Entity::Entity()
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(0.0f), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(0), m_velocity(0.0f), m_acceleration(0.0f), m_width(0.0f), m_height(0.0f)
+    : m_movement(0.0f), m_position(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_velocity(0.0f), m_acceleration(0.0f),
+    m_model_matrix(1.0f), m_speed(0.0f), m_texture_id(0), m_animation_cols(0), m_animation_frames(0),
+    m_animation_index(0), m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
+    m_width(0.0f), m_height(0.0f)
 {
     // Initialize m_walking with zeros or any default value
-    for (int i = 0; i < SECONDS_PER_FRAME; ++i)
-        for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 1; ++j) m_walking[i][j] = 0;
 }
 
 // Parameterized constructor
 Entity::Entity(GLuint texture_id, float speed, glm::vec3 acceleration, float jump_power, int walking[4][1], float animation_time,
     int animation_frames, int animation_index, int animation_cols,
     int animation_rows, float width, float height)
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed), m_acceleration(acceleration), m_jumping_power(jump_power), m_animation_cols(animation_cols),
-    m_animation_frames(animation_frames), m_animation_index(animation_index),
-    m_animation_rows(animation_rows), m_animation_indices(nullptr),
-    m_animation_time(animation_time), m_texture_id(texture_id), m_velocity(0.0f),
+    : m_movement(0.0f), m_position(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_velocity(0.0f), m_acceleration(acceleration),
+    m_model_matrix(1.0f), m_speed(speed), m_jumping_power(jump_power), m_texture_id(texture_id),
+    m_animation_cols(animation_cols), m_animation_frames(animation_frames), m_animation_index(animation_index),
+    m_animation_rows(animation_rows), m_animation_indices(nullptr), m_animation_time(animation_time),
     m_width(width), m_height(height)
 {
     face_right();
@@ -42,14 +41,14 @@ Entity::Entity(GLuint texture_id, float speed, glm::vec3 acceleration, float jum
 
 // Simpler constructor for partial initialization
 Entity::Entity(GLuint texture_id, float speed, glm::vec3 acceleration, float width, float height)
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(texture_id), m_velocity(0.0f), m_acceleration(acceleration), m_width(width), m_height(height)
+    : m_movement(0.0f), m_position(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_velocity(0.0f), m_acceleration(acceleration),
+    m_model_matrix(1.0f), m_speed(speed), m_texture_id(texture_id), m_animation_cols(0), m_animation_frames(0),
+    m_animation_index(0), m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
+    m_width(width), m_height(height)
 {
     // Initialize m_walking with zeros or any default value
-    for (int i = 0; i < SECONDS_PER_FRAME; ++i)
-        for (int j = 0; j < SECONDS_PER_FRAME; ++j) m_walking[i][j] = 0;
+    for (int i = 0; i < 4; ++i)
+        for (int j = 0; j < 1; ++j) m_walking[i][j] = 0;
 }
 
 Entity::~Entity() { }
@@ -102,86 +101,123 @@ bool const Entity::check_collision(Entity* other) const
     return x_distance < 0.0f && y_distance < 0.0f;
 }
 
-void const Entity::check_collision_y(Entity* collidable_entities, int collidable_entity_count)
+bool Entity::resolve_collision_y(const glm::vec3& position, float width, float height)
 {
-    for (int i = 0; i < collidable_entity_count; i++)
+    float x_distance = fabs(m_position.x - position.x) - ((m_width + width) / 2.0f);
+    float y_distance = fabs(m_position.y - position.y) - ((m_height + height) / 2.0f);
+    if (x_distance >= 0.0f || y_distance >= 0.0f) return false;
+
+    float y_overlap = fabs(fabs(m_position.y - position.y) - (m_height / 2.0f) - (height / 2.0f));
+    if (m_velocity.y > 0)
     {
-        Entity* collidable_entity = &collidable_entities[i];
+        m_position.y -= y_overlap;
+        m_velocity.y = 0;
+        m_acceleration.y = 0;
 
-        if (check_collision(collidable_entity))
-        {
-            //std::cout << "collide\n\n";
-            float y_distance = fabs(m_position.y - collidable_entity->m_position.y);
-            float y_overlap = fabs(y_distance - (m_height / 2.0f) - (collidable_entity->m_height / 2.0f));
-            if (m_velocity.y > 0)
-            {
-                m_position.y -= y_overlap;
-                m_velocity.y = 0;
-                m_acceleration.y = 0;
+        // Collision!
+        m_collided_top = true;
+        return true;
+    }
+    else if (m_velocity.y < 0)
+    {
+        m_position.y += y_overlap;
+        m_velocity.y = 0;
+        m_acceleration.y = 0;
 
-                // Collision!
-                m_collided_top = true;
+        // Collision!
+        m_collided_bottom = true;
+        return true;
+    }
+    return false;
+}
 
-            }
-            else if (m_velocity.y < 0)
-            {
-                m_position.y += y_overlap;
-                m_velocity.y = 0;
-                m_acceleration.y = 0;
+bool Entity::resolve_collision_x(const glm::vec3& position, float width, float height)
+{
+    float x_distance = fabs(m_position.x - position.x) - ((m_width + width) / 2.0f);
+    float y_distance = fabs(m_position.y - position.y) - ((m_height + height) / 2.0f);
+    if (x_distance >= 0.0f || y_distance >= 0.0f) return false;
 
-                // Collision!
-                m_collided_bottom = true;
-            }
-        }
+    float x_overlap = fabs(fabs(m_position.x - position.x) - (m_width / 2.0f) - (width / 2.0f));
+    if (m_velocity.x > 0)
+    {
+        m_position.x -= x_overlap;
+        m_velocity.x = 0;
+        m_acceleration.x = 0;
+
+        // Collision!
+        m_collided_right = true;
+        return true;
+    }
+    else if (m_velocity.x < 0)
+    {
+        m_position.x += x_overlap;
+        m_velocity.x = 0;
+        m_acceleration.x = 0;
+
+        // Collision!
+        m_collided_left = true;
+        return true;
     }
+    return false;
 }
 
-void const Entity::check_collision_x(Entity* collidable_entities, int collidable_entity_count)
+void const Entity::check_collision_y(Entity* collidable_entities, int collidable_entity_count)
 {
     for (int i = 0; i < collidable_entity_count; i++)
     {
         Entity* collidable_entity = &collidable_entities[i];
+        resolve_collision_y(collidable_entity->m_position, collidable_entity->m_width, collidable_entity->m_height);
+    }
+}
 
-        if (check_collision(collidable_entity))
-        {
-            float x_distance = fabs(m_position.x - collidable_entity->m_position.x);
-            float x_overlap = fabs(x_distance - (m_width / 2.0f) - (collidable_entity->m_width / 2.0f));
-            if (m_velocity.x > 0)
-            {
-                m_position.x -= x_overlap;
-                m_velocity.x = 0;
-                m_acceleration.x = 0;
+void const Entity::check_collision_x(Entity* collidable_entities, int collidable_entity_count)
+{
+    for (int i = 0; i < collidable_entity_count; i++)
+    {
+        Entity* collidable_entity = &collidable_entities[i];
+        resolve_collision_x(collidable_entity->m_position, collidable_entity->m_width, collidable_entity->m_height);
+    }
+}
 
-                // Collision!
-                m_collided_right = true;
+void const Entity::check_collision_y(const Level* level)
+{
+    int first, last;
+    level->query(m_position.x - m_width / 2.0f, m_position.x + m_width / 2.0f, &first, &last);
 
-            }
-            else if (m_velocity.x < 0)
-            {
-                m_position.x += x_overlap;
-                m_velocity.x = 0;
-                m_acceleration.x = 0;
+    for (int box = first; box < last; box++)
+    {
+        bool falling = m_velocity.y < 0;
 
-                // Collision!
-                m_collided_left = true;
-            }
+        glm::vec3 position(level->get_x(box), level->get_y(box), 0.0f);
+        if (resolve_collision_y(position, level->get_width(box), level->get_height(box)))
+        {
+            if (level->get_kind(box) == LEVEL_TERRAIN) m_collided_terrain = true;
+            else if (falling) m_landed_on_pad = true;
         }
     }
 }
-void Entity::update(float delta_time, Entity* collidable_entities, int collidable_entity_count)
 
+void const Entity::check_collision_x(const Level* level)
+{
+    int first, last;
+    level->query(m_position.x - m_width / 2.0f, m_position.x + m_width / 2.0f, &first, &last);
+
+    for (int box = first; box < last; box++)
+    {
+        glm::vec3 position(level->get_x(box), level->get_y(box), 0.0f);
+        if (resolve_collision_x(position, level->get_width(box), level->get_height(box)) &&
+            level->get_kind(box) == LEVEL_TERRAIN) m_collided_terrain = true;
+    }
+}
+
+void Entity::start_update(float delta_time)
 {
     m_collided_top = false;
     m_collided_bottom = false;
     m_collided_left = false;
     m_collided_right = false;
-    //for (int i = 0; i < collidable_entity_count; i++)
-    //{
-    //    if (check_collision(&collidable_entities[i])) {
-    //        std::cout << "count: " << collidable_entity_count << "\n";
-    //        std::cout << i << "\n"; return;
-    //    }
-    //}
+    m_landed_on_pad = false;
+    m_collided_terrain = false;
 
     if (m_animation_indices != NULL)
     {
@@ -206,15 +242,30 @@ void Entity::update(float delta_time, Entity* collidable_entities, int collidabl
     // Our character moves from left to right, so they need an initial velocity
     //m_velocity.x = m_movement.x * m_speed;
 
+    if (m_has_thrusters)
+    {
+        m_acceleration = m_gravity;
+        if (m_energy > 0)
+        {
+            if (m_thrust.x != 0)
+            {
+                m_acceleration.x = m_thrust.x * ACCELERATION;
+                m_energy -= ENERGY_BURN_RATE * delta_time;
+            }
+            if (m_thrust.y != 0)
+            {
+                m_acceleration.y = m_thrust.y * ACCELERATION;
+                m_energy -= ENERGY_BURN_RATE * delta_time;
+            }
+        }
+    }
+
     // And we add the gravity next
     m_velocity += m_acceleration * delta_time;
+}
 
-    m_position.y += m_velocity.y * delta_time;
-    check_collision_y(collidable_entities, collidable_entity_count);
-
-    m_position.x += m_velocity.x * delta_time;
-    check_collision_x(collidable_entities, collidable_entity_count);
-
+void Entity::finish_update()
+{
     if (m_is_jumping)
     {
         m_is_jumping = false;
@@ -236,6 +287,32 @@ void Entity::update(float delta_time, Entity* collidable_entities, int collidabl
     m_model_matrix = glm::scale(m_model_matrix, m_scale);
 }
 
+void Entity::update(float delta_time, Entity* collidable_entities, int collidable_entity_count)
+{
+    start_update(delta_time);
+
+    m_position.y += m_velocity.y * delta_time;
+    check_collision_y(collidable_entities, collidable_entity_count);
+
+    m_position.x += m_velocity.x * delta_time;
+    check_collision_x(collidable_entities, collidable_entity_count);
+
+    finish_update();
+}
+
+void Entity::update(float delta_time, const Level* level)
+{
+    start_update(delta_time);
+
+    m_position.y += m_velocity.y * delta_time;
+    check_collision_y(level);
+
+    m_position.x += m_velocity.x * delta_time;
+    check_collision_x(level);
+
+    finish_update();
+}
+
 void Entity::render(ShaderProgram* program)
 {
     program->set_model_matrix(m_model_matrix);
@@ -3,9 +3,10 @@
 
 #include "glm/glm.hpp"
 #include "ShaderProgram.h"
+#include "LanderEnv.h"
+#include "Level.h"
 
 enum AnimationDirection { LEFT, RIGHT, UP, DOWN };
-constexpr float ACCELERATION = 0.015f;
 
 class Entity
 {
@@ -50,6 +51,23 @@ private:
     bool m_collided_bottom = false;
     bool m_collided_left = false;
     bool m_collided_right = false;
+    bool m_landed_on_pad = false;       // against a Level: came down on a pad
+    bool m_collided_terrain = false;    // against a Level: hit terrain from any side
+
+    //  THRUST  //
+    bool m_has_thrusters = false;
+    glm::vec3 m_gravity = glm::vec3(0.0f);
+    glm::vec3 m_thrust = glm::vec3(0.0f);  // -1, 0 or 1 on each axis, from the controls
+    float m_energy = 0.0f;
+
+    // Pushes this entity back out of one box along y or x if they overlap,
+    // as check_collision_y / _x do for each entity; true if it did
+    bool resolve_collision_y(const glm::vec3& position, float width, float height);
+    bool resolve_collision_x(const glm::vec3& position, float width, float height);
+
+    // The parts of update() either side of moving and colliding
+    void start_update(float delta_time);
+    void finish_update();
 
 public:
     //  STATIC VARIABLES  //
@@ -69,6 +87,12 @@ public:
     void const check_collision_y(Entity* collidable_entities, int collidable_entity_count);
     void const check_collision_x(Entity* collidable_entities, int collidable_entity_count);
     void update(float delta_time, Entity* collidable_entities, int collidable_entity_count);
+
+    // The same against a Level, testing only the boxes the level's query
+    // finds near the entity rather than every one
+    void const check_collision_y(const Level* level);
+    void const check_collision_x(const Level* level);
+    void update(float delta_time, const Level* level);
     void render(ShaderProgram* program);
 
     void normalise_movement() { m_movement = glm::normalize(m_movement); }
@@ -78,10 +102,21 @@ public:
     void face_up() { m_animation_indices = m_walking[UP]; }
     void face_down() { m_animation_indices = m_walking[DOWN]; }
 
-    void move_left() { m_acceleration.x = -ACCELERATION; face_left(); }
-    void move_right() { m_acceleration.x = ACCELERATION; face_right(); }
-    void move_up() { m_acceleration.y = ACCELERATION; face_up(); }
-    void move_down() { m_acceleration.y = -ACCELERATION; face_down(); }
+    void move_left() { m_thrust.x = -1.0f; face_left(); }
+    void move_right() { m_thrust.x = 1.0f; face_right(); }
+    void move_up() { m_thrust.y = 1.0f; face_up(); }
+    void move_down() { m_thrust.y = -1.0f; face_down(); }
+
+    // From now on each update() sets the acceleration to gravity, replaced on
+    // each axis being thrust along by ACCELERATION that way for as long as the
+    // energy lasts, and burns ENERGY_BURN_RATE of it per second per axis
+    void set_thrusters(glm::vec3 gravity, float energy)
+    {
+        m_has_thrusters = true;
+        m_gravity = gravity;
+        m_energy = energy;
+    }
+    void const set_thrust(glm::vec3 new_thrust) { m_thrust = new_thrust; }
 
 
     void const jump() { m_is_jumping = true; }
@@ -98,6 +133,9 @@ public:
     bool      const get_collided_bottom() const { return m_collided_bottom; }
     bool      const get_collided_right() const { return m_collided_right; }
     bool      const get_collided_left() const { return m_collided_left; }
+    bool      const get_landed_on_pad() const { return m_landed_on_pad; }
+    bool      const get_collided_terrain() const { return m_collided_terrain; }
+    float     const get_energy() const { return m_energy; }
     float const get_width() const { return m_width; }
     float const get_height() const { return m_height; }
     //  SETTERS  //
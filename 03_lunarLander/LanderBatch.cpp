@@ -0,0 +1,201 @@
+#include "LanderBatch.h"
+
+LanderBatch::LanderBatch(int size, unsigned int seed)
+    : m_x(size), m_y(size), m_velocity_x(size), m_velocity_y(size),
+      m_energy(size), m_potential(size), m_frame(size), m_seed(size)
+{
+    reset(seed);
+}
+
+void LanderBatch::reset_lane(int lane, unsigned int seed)
+{
+    LanderEnv env;
+    env.reset(seed);
+    const LanderState &state = env.get_state();
+
+    m_x[lane] = state.position.x;
+    m_y[lane] = state.position.y;
+    m_velocity_x[lane] = state.velocity.x;
+    m_velocity_y[lane] = state.velocity.y;
+    m_energy[lane] = state.energy;
+    m_potential[lane] = LanderEnv::potential(state.position.x, state.position.y, state.velocity.x, state.velocity.y);
+    m_frame[lane] = 0;
+    m_seed[lane] = seed;
+}
+
+void LanderBatch::reset(unsigned int seed)
+{
+    for (int lane = 0; lane < get_size(); lane++) reset_lane(lane, seed + lane);
+    m_next_seed = seed + get_size();
+    for (long long &count : m_episodes) count = 0;
+}
+
+/* the kernel */
+// LanderEnv::thrust, collide_y and collide_x, with each test a 0 or 1 mask
+// and each outcome blended in with it, as BallField's step_balls does in
+// 02_Pong. Every blend adds or multiplies by an exact 0 or 1, so the results
+// are the scalar ones to the bit. The collisions leave the acceleration be,
+// since each move works it out afresh.
+static inline void thrust(int input, float *energy, float *acceleration_x, float *acceleration_y)
+{
+    // left wins over right and up over down
+    float has_energy = *energy > 0 ? 1.0f : 0.0f;
+    float left = (input & LANDER_LEFT) ? has_energy : 0.0f;
+    float right = (input & LANDER_RIGHT) ? has_energy - left : 0.0f;
+    float up = (input & LANDER_UP) ? has_energy : 0.0f;
+    float down = (input & LANDER_DOWN) ? has_energy - up : 0.0f;
+
+    *acceleration_x = (right - left) * ACCELERATION;
+    *acceleration_y = (up - down) * ACCELERATION + (1.0f - up - down) * GRAVITY;
+    *energy -= (left + right) * (ENERGY_BURN_RATE * LanderEnv::FIXED_TIMESTEP);
+    *energy -= (up + down) * (ENERGY_BURN_RATE * LanderEnv::FIXED_TIMESTEP);
+}
+
+static inline void collide_y(float x, float *y, float *velocity_y, float *bottom,
+                             float box_x, float box_y, float box_width, float box_height)
+{
+    float x_distance = fabs(x - box_x) - (PLAYER_SIZE + box_width) / 2.0f;
+    float y_distance = fabs(*y - box_y) - (PLAYER_SIZE + box_height) / 2.0f;
+    float touching = x_distance < 0.0f ? 1.0f : 0.0f;
+    touching = y_distance < 0.0f ? touching : 0.0f;
+
+    float y_overlap = fabs(fabs(*y - box_y) - PLAYER_SIZE / 2.0f - box_height / 2.0f);
+    float from_below = *velocity_y > 0 ? touching : 0.0f;
+    float from_above = *velocity_y < 0 ? touching : 0.0f;
+
+    *y += (from_above - from_below) * y_overlap;
+    *velocity_y *= 1.0f - from_below - from_above;
+    *bottom += from_above;
+}
+
+static inline void collide_x(float *x, float y, float *velocity_x, float *side,
+                             float box_x, float box_y, float box_width, float box_height)
+{
+    float x_distance = fabs(*x - box_x) - (PLAYER_SIZE + box_width) / 2.0f;
+    float y_distance = fabs(y - box_y) - (PLAYER_SIZE + box_height) / 2.0f;
+    float touching = x_distance < 0.0f ? 1.0f : 0.0f;
+    touching = y_distance < 0.0f ? touching : 0.0f;
+
+    float x_overlap = fabs(fabs(*x - box_x) - PLAYER_SIZE / 2.0f - box_width / 2.0f);
+    float from_left = *velocity_x > 0 ? touching : 0.0f;
+    float from_right = *velocity_x < 0 ? touching : 0.0f;
+
+    *x += (from_right - from_left) * x_overlap;
+    *velocity_x *= 1.0f - from_left - from_right;
+    *side += from_left + from_right;
+}
+
+// Every lane's step over raw arrays, restrict parameters so the compiler can
+// vectorise it. Writes each lane's reward and outcome; resetting finished
+// lanes is left to the caller.
+//
+// GCC vectorises this only with -fno-trapping-math and -fno-math-errno (for
+// the square roots in the reward). Where FMA is available, -ffp-contract=off
+// too is needed for lanes to match LanderEnv to the bit, since the vector and
+// scalar code would otherwise fuse different multiply-adds.
+static void step_landers(float *__restrict x_array, float *__restrict y_array,
+                         float *__restrict velocity_x_array, float *__restrict velocity_y_array,
+                         float *__restrict energy_array, float *__restrict potential_array,
+                         int *__restrict frame_array, const unsigned char *__restrict inputs,
+                         float *__restrict rewards, unsigned char *__restrict outcomes, int size)
+{
+    const float step = LanderEnv::FIXED_TIMESTEP;
+
+    for (int i = 0; i < size; i++) {
+        float x = x_array[i], y = y_array[i];
+        float velocity_x = velocity_x_array[i], velocity_y = velocity_y_array[i];
+        float energy = energy_array[i], energy_after = energy;
+        int input = inputs[i];
+        float acceleration_x, acceleration_y;
+
+        // against the forests
+        float forest_bottom = 0.0f, forest_side = 0.0f;
+        thrust(input, &energy_after, &acceleration_x, &acceleration_y);
+        velocity_x += acceleration_x * step;
+        velocity_y += acceleration_y * step;
+        y += velocity_y * step;
+        for (int j = 0; j < FOREST_COUNT; j++)
+            collide_y(x, &y, &velocity_y, &forest_bottom,
+                      FOREST_POSITIONS[j].x, FOREST_POSITIONS[j].y, FOREST_WIDTH, FOREST_HEIGHT);
+        x += velocity_x * step;
+        for (int j = 0; j < FOREST_COUNT; j++)
+            collide_x(&x, y, &velocity_x, &forest_side,
+                      FOREST_POSITIONS[j].x, FOREST_POSITIONS[j].y, FOREST_WIDTH, FOREST_HEIGHT);
+
+        // and again against the ground
+        float ground_bottom = 0.0f, ground_side = 0.0f;
+        thrust(input, &energy_after, &acceleration_x, &acceleration_y);
+        velocity_x += acceleration_x * step;
+        velocity_y += acceleration_y * step;
+        y += velocity_y * step;
+        collide_y(x, &y, &velocity_y, &ground_bottom,
+                  GROUND_POSITION.x, GROUND_POSITION.y, GROUND_WIDTH, GROUND_HEIGHT);
+        x += velocity_x * step;
+        collide_x(&x, y, &velocity_x, &ground_side,
+                  GROUND_POSITION.x, GROUND_POSITION.y, GROUND_WIDTH, GROUND_HEIGHT);
+
+        float inside = x >= -OUT_OF_BOUNDS_X ? 1.0f : 0.0f;
+        inside = x <= OUT_OF_BOUNDS_X ? inside : 0.0f;
+        inside = y >= -OUT_OF_BOUNDS_Y ? inside : 0.0f;
+        inside = y <= OUT_OF_BOUNDS_Y ? inside : 0.0f;
+
+        float won = ground_bottom > 0.0f ? inside : 0.0f;
+        float lost = forest_bottom + forest_side > 0.0f ? 1.0f - won : 1.0f - inside;
+
+        int frame = frame_array[i] + 1;
+        float timed_out = frame >= LanderEnv::MAX_EPISODE_FRAMES ? 1.0f - won - lost : 0.0f;
+
+        float next_potential = LanderEnv::potential(x, y, velocity_x, velocity_y);
+        float reward = next_potential - potential_array[i] - (energy - energy_after);
+        reward += won * LanderEnv::WIN_REWARD + lost * LanderEnv::LOSE_REWARD;
+
+        x_array[i] = x;
+        y_array[i] = y;
+        velocity_x_array[i] = velocity_x;
+        velocity_y_array[i] = velocity_y;
+        energy_array[i] = energy_after;
+        potential_array[i] = next_potential;
+        frame_array[i] = frame;
+        rewards[i] = reward;
+        outcomes[i] = (unsigned char) (won * LANDER_WON + lost * LANDER_LOST + timed_out * LANDER_TIMED_OUT);
+    }
+}
+
+void LanderBatch::step(const unsigned char *inputs, float *rewards, unsigned char *outcomes)
+{
+    const int size = get_size();
+    step_landers(m_x.data(), m_y.data(), m_velocity_x.data(), m_velocity_y.data(),
+                 m_energy.data(), m_potential.data(), m_frame.data(), inputs, rewards, outcomes, size);
+
+    // Episodes end once every few hundred steps, so this pass rarely does more
+    // than read the outcomes
+    for (int lane = 0; lane < size; lane++) {
+        if (outcomes[lane] == LANDER_RUNNING) continue;
+        m_episodes[outcomes[lane]]++;
+        reset_lane(lane, m_next_seed++);
+    }
+}
+
+void LanderBatch::observe(float *observations) const
+{
+    for (int lane = 0; lane < get_size(); lane++) {
+        float *observation = observations + lane * LanderEnv::OBSERVATION_SIZE;
+        observation[0] = m_x[lane];
+        observation[1] = m_y[lane];
+        observation[2] = m_velocity_x[lane];
+        observation[3] = m_velocity_y[lane];
+        observation[4] = m_energy[lane] / ENERGY_MAX;
+        observation[5] = GROUND_POSITION.x - m_x[lane];
+        observation[6] = (GROUND_POSITION.y + GROUND_HEIGHT / 2.0f) - (m_y[lane] - PLAYER_SIZE / 2.0f);
+    }
+}
+
+LanderState const LanderBatch::get_state(int lane) const
+{
+    LanderState state;
+    state.frame = m_frame[lane];
+    state.position = glm::vec3(m_x[lane], m_y[lane], 0.0f);
+    state.velocity = glm::vec3(m_velocity_x[lane], m_velocity_y[lane], 0.0f);
+    state.energy = m_energy[lane];
+    return state;
+}
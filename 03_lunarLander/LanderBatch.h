@@ -0,0 +1,60 @@
+#pragma once
+#include <vector>
+#include "LanderEnv.h"
+
+// How a lander's episode ended on a step of LanderBatch
+enum LanderOutcome : unsigned char
+{
+    LANDER_RUNNING = 0,
+    LANDER_WON,
+    LANDER_LOST,
+    LANDER_TIMED_OUT
+};
+
+// Many independent LanderEnvs stepped in lockstep.
+//
+// The landers are stored as one array per field, so a step is one pass of
+// straight-line arithmetic over contiguous floats that the compiler turns into
+// SIMD, and each lane comes out bit for bit the same as a LanderEnv given the
+// same seed and inputs. A lane whose episode ends is reset straight away with
+// the next seed, so every step is a step of a live episode.
+//
+// Vectorised, a step costs a fraction of a LanderEnv step per lane, but only
+// pays off from a few hundred lanes up.
+class LanderBatch
+{
+private:
+    std::vector<float> m_x, m_y;
+    std::vector<float> m_velocity_x, m_velocity_y;
+    std::vector<float> m_energy;
+    std::vector<float> m_potential;
+    std::vector<int> m_frame;
+    std::vector<unsigned int> m_seed;       // the seed each lane's episode started from
+
+    unsigned int m_next_seed = 1;
+    long long m_episodes[4] = { 0, 0, 0, 0 };   // finished episodes, by LanderOutcome
+
+    void reset_lane(int lane, unsigned int seed);
+
+public:
+    LanderBatch(int size, unsigned int seed = 1);
+
+    // Lane i starts from seed + i, and finished episodes take the seeds after
+    // those in lane order
+    void reset(unsigned int seed);
+
+    // One step of every lane: inputs, rewards and outcomes hold one entry per
+    // lane. Lanes that finish are reset before this returns, so their next
+    // observation is the first of a new episode.
+    void step(const unsigned char *inputs, float *rewards, unsigned char *outcomes);
+
+    // LanderEnv::OBSERVATION_SIZE floats per lane, lane after lane
+    void observe(float *observations) const;
+
+    int const get_size() const { return (int) m_x.size(); }
+    unsigned int const get_seed(int lane) const { return m_seed[lane]; }
+    long long const get_episode_count(LanderOutcome outcome) const { return m_episodes[outcome]; }
+
+    // One lane as a LanderEnv would hold it
+    LanderState const get_state(int lane) const;
+};
@@ -0,0 +1,218 @@
+#include "LanderEnv.h"
+
+unsigned int LanderEnv::next_random(unsigned int *random_state)
+{
+    unsigned int x = *random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *random_state = x;
+    return x;
+}
+
+float LanderEnv::random_between(unsigned int *random_state, float min, float max)
+{
+    return min + (max - min) * (next_random(random_state) % 10001 / 10000.0f);
+}
+
+void LanderEnv::reset(unsigned int seed)
+{
+    m_state = LanderState();
+    m_state.random_state = seed == 0 ? 1 : seed;
+
+    if (seed != 0) {
+        float left = m_level ? m_level->get_left_edge() + PLAYER_SIZE : -4.5f;
+        float right = m_level ? m_level->get_right_edge() - PLAYER_SIZE : 4.5f;
+        m_state.position.x = random_between(&m_state.random_state, left, right);
+        m_state.velocity.x = random_between(&m_state.random_state, -0.2f, 0.2f);
+        m_state.velocity.y = random_between(&m_state.random_state, -0.2f, 0.0f);
+    }
+
+    m_potential = potential();
+}
+
+bool LanderEnv::collide_y(LanderState *state, const glm::vec3 &position, float width, float height, bool *bottom)
+{
+    float x_distance = fabs(state->position.x - position.x) - (PLAYER_SIZE + width) / 2.0f;
+    float y_distance = fabs(state->position.y - position.y) - (PLAYER_SIZE + height) / 2.0f;
+    if (x_distance >= 0.0f || y_distance >= 0.0f) return false;
+
+    float y_overlap = fabs(fabs(state->position.y - position.y) - PLAYER_SIZE / 2.0f - height / 2.0f);
+    if (state->velocity.y > 0) {
+        state->position.y -= y_overlap;
+    }
+    else if (state->velocity.y < 0) {
+        state->position.y += y_overlap;
+        *bottom = true;
+    }
+    else return false;
+
+    state->velocity.y = 0;
+    state->acceleration.y = 0;
+    return true;
+}
+
+bool LanderEnv::collide_x(LanderState *state, const glm::vec3 &position, float width, float height)
+{
+    float x_distance = fabs(state->position.x - position.x) - (PLAYER_SIZE + width) / 2.0f;
+    float y_distance = fabs(state->position.y - position.y) - (PLAYER_SIZE + height) / 2.0f;
+    if (x_distance >= 0.0f || y_distance >= 0.0f) return false;
+
+    float x_overlap = fabs(fabs(state->position.x - position.x) - PLAYER_SIZE / 2.0f - width / 2.0f);
+    if (state->velocity.x > 0) state->position.x -= x_overlap;
+    else if (state->velocity.x < 0) state->position.x += x_overlap;
+    else return false;
+
+    state->velocity.x = 0;
+    state->acceleration.x = 0;
+    return true;
+}
+
+void LanderEnv::thrust(LanderState *state, unsigned char input)
+{
+    state->acceleration = glm::vec3(0.0f, GRAVITY, 0.0f);
+    if (state->energy <= 0) return;
+
+    float thrust_x = (input & LANDER_LEFT) ? -1.0f : ((input & LANDER_RIGHT) ? 1.0f : 0.0f);
+    float thrust_y = (input & LANDER_UP) ? 1.0f : ((input & LANDER_DOWN) ? -1.0f : 0.0f);
+    if (thrust_x != 0) {
+        state->acceleration.x = thrust_x * ACCELERATION;
+        state->energy -= ENERGY_BURN_RATE * FIXED_TIMESTEP;
+    }
+    if (thrust_y != 0) {
+        state->acceleration.y = thrust_y * ACCELERATION;
+        state->energy -= ENERGY_BURN_RATE * FIXED_TIMESTEP;
+    }
+}
+
+void LanderEnv::move(LanderState *state, unsigned char input, const glm::vec3 *positions, float width, float height,
+                     int count, bool *bottom, bool *side)
+{
+    thrust(state, input);
+    state->velocity += state->acceleration * FIXED_TIMESTEP;
+
+    state->position.y += state->velocity.y * FIXED_TIMESTEP;
+    for (int i = 0; i < count; i++) collide_y(state, positions[i], width, height, bottom);
+
+    state->position.x += state->velocity.x * FIXED_TIMESTEP;
+    for (int i = 0; i < count; i++) *side = collide_x(state, positions[i], width, height) || *side;
+}
+
+void LanderEnv::move(LanderState *state, unsigned char input, const Level &level, bool *landed, bool *crashed)
+{
+    thrust(state, input);
+    state->velocity += state->acceleration * FIXED_TIMESTEP;
+    int first, last;
+
+    state->position.y += state->velocity.y * FIXED_TIMESTEP;
+    level.query(state->position.x - PLAYER_SIZE / 2.0f, state->position.x + PLAYER_SIZE / 2.0f, &first, &last);
+    for (int box = first; box < last; box++) {
+        bool bottom = false;
+        glm::vec3 position(level.get_x(box), level.get_y(box), 0.0f);
+        if (!collide_y(state, position, level.get_width(box), level.get_height(box), &bottom)) continue;
+
+        if (level.get_kind(box) == LEVEL_TERRAIN) *crashed = true;
+        else if (bottom) *landed = true;
+    }
+
+    state->position.x += state->velocity.x * FIXED_TIMESTEP;
+    level.query(state->position.x - PLAYER_SIZE / 2.0f, state->position.x + PLAYER_SIZE / 2.0f, &first, &last);
+    for (int box = first; box < last; box++) {
+        glm::vec3 position(level.get_x(box), level.get_y(box), 0.0f);
+        if (collide_x(state, position, level.get_width(box), level.get_height(box)) &&
+            level.get_kind(box) == LEVEL_TERRAIN) *crashed = true;
+    }
+}
+
+void const LanderEnv::target_pad(float *pad_x, float *pad_top) const
+{
+    int pad = m_level ? m_level->nearest_pad(m_state.position.x) : -1;
+    if (pad < 0) {
+        *pad_x = GROUND_POSITION.x;
+        *pad_top = GROUND_POSITION.y + GROUND_HEIGHT / 2.0f;
+        return;
+    }
+    *pad_x = m_level->get_x(pad);
+    *pad_top = m_level->get_y(pad) + m_level->get_height(pad) / 2.0f;
+}
+
+float const LanderEnv::potential() const
+{
+    float pad_x, pad_top;
+    target_pad(&pad_x, &pad_top);
+    return potential(m_state.position.x, m_state.position.y, m_state.velocity.x, m_state.velocity.y, pad_x, pad_top);
+}
+
+LanderStep LanderEnv::step(unsigned char input)
+{
+    LanderStep result;
+    if (m_state.result != NONE) {
+        result.done = true;
+        return result;
+    }
+
+    float energy_before = m_state.energy;
+
+    float bound_left = -OUT_OF_BOUNDS_X, bound_right = OUT_OF_BOUNDS_X;
+    if (m_level) {
+        // update() on a generated level: one move against all of it
+        bool landed = false, crashed = false;
+        move(&m_state, input, *m_level, &landed, &crashed);
+
+        if (crashed) m_state.result = LOSE;
+        if (landed) m_state.result = WIN;
+
+        // half a unit past the level's edges, as the game's bounds are past
+        // the screen's
+        bound_left = m_level->get_left_edge() - 0.5f;
+        bound_right = m_level->get_right_edge() + 0.5f;
+    }
+    else {
+        // update(): the game moves the player once against the forests and
+        // then again against the ground, each a full step, and so do we
+        bool forest_bottom = false, forest_side = false;
+        move(&m_state, input, FOREST_POSITIONS, FOREST_WIDTH, FOREST_HEIGHT, FOREST_COUNT, &forest_bottom, &forest_side);
+
+        bool ground_bottom = false, ground_side = false;
+        move(&m_state, input, &GROUND_POSITION, GROUND_WIDTH, GROUND_HEIGHT, 1, &ground_bottom, &ground_side);
+
+        if (forest_bottom || forest_side) m_state.result = LOSE;
+        if (ground_bottom) m_state.result = WIN;
+    }
+
+    if (m_state.position.x < bound_left || m_state.position.x > bound_right ||
+        m_state.position.y < -OUT_OF_BOUNDS_Y || m_state.position.y > OUT_OF_BOUNDS_Y)
+        m_state.result = LOSE;
+
+    m_state.frame++;
+
+    // Shaped so that moving towards the pad and slowing down pays, fuel costs
+    // what it burns, and the outcome dominates
+    float next_potential = potential();
+    result.reward = next_potential - m_potential - (energy_before - m_state.energy);
+    m_potential = next_potential;
+
+    if (m_state.result == WIN) result.reward += WIN_REWARD;
+    if (m_state.result == LOSE) result.reward += LOSE_REWARD;
+
+    result.done = m_state.result != NONE;
+    if (!result.done && m_state.frame >= MAX_EPISODE_FRAMES) {
+        result.done = true;
+        result.timed_out = true;
+    }
+    return result;
+}
+
+void LanderEnv::observe(float *observation) const
+{
+    float pad_x, pad_top;
+    target_pad(&pad_x, &pad_top);
+
+    observation[0] = m_state.position.x;
+    observation[1] = m_state.position.y;
+    observation[2] = m_state.velocity.x;
+    observation[3] = m_state.velocity.y;
+    observation[4] = m_state.energy / ENERGY_MAX;
+    observation[5] = pad_x - m_state.position.x;
+    observation[6] = pad_top - (m_state.position.y - PLAYER_SIZE / 2.0f);
+}
@@ -0,0 +1,143 @@
+#pragma once
+#include <cmath>
+#include "glm/glm.hpp"
+#include "Level.h"
+
+enum GameResult { WIN, LOSE, NONE };
+
+/* level constants */
+constexpr float FOREST_HEIGHT = 2.0f;
+constexpr float FOREST_WIDTH = 1280 / 374.0f * FOREST_HEIGHT; //6.84
+constexpr float GROUND_HEIGHT = 0.48f;
+constexpr float GROUND_WIDTH = 360 / 78.0f * GROUND_HEIGHT; //2.22
+
+constexpr int FOREST_COUNT = 2;
+constexpr glm::vec3 FOREST_POSITIONS[FOREST_COUNT] = { glm::vec3(-4.0f, -3.1f, 0.0f), glm::vec3(5.0f, -3.1f, 0.0f) };
+constexpr glm::vec3 GROUND_POSITION = glm::vec3(0.5f, -3.5f, 0.0f);
+
+constexpr glm::vec3 PLAYER_INIT_POS = glm::vec3(-4.0f, 2.5f, 0.0f);
+constexpr float PLAYER_SIZE = 1.0f;         // the player's scale, which is also its collision box
+
+constexpr float GRAVITY = -0.02f;
+constexpr float ACCELERATION = 0.015f;      // thrust from each arrow key, in place of gravity on its axis
+constexpr float ENERGY_MAX = 400.0f;
+
+// Per axis thrusting, per second of Entity::update. The game updates the
+// player twice a step, so a held key costs 0.01 a step.
+constexpr float ENERGY_BURN_RATE = 0.3f;
+
+// Leaving this box is a loss
+constexpr float OUT_OF_BOUNDS_X = 5.5f,
+OUT_OF_BOUNDS_Y = 4.5f;
+
+/* input */
+// The arrow keys held for one step. As in the game, left wins over right and
+// up over down when both are held.
+enum LanderInputBits : unsigned char
+{
+    LANDER_LEFT  = 1 << 0,
+    LANDER_RIGHT = 1 << 1,
+    LANDER_UP    = 1 << 2,
+    LANDER_DOWN  = 1 << 3
+};
+
+/* state */
+struct LanderState
+{
+    int frame = 0;
+    GameResult result = NONE;
+
+    glm::vec3 position = PLAYER_INIT_POS;
+    glm::vec3 velocity = glm::vec3(0.0f);
+    glm::vec3 acceleration = glm::vec3(0.0f);
+    float energy = ENERGY_MAX;
+
+    unsigned int random_state = 1;
+};
+
+// What a step hands back to a learner
+struct LanderStep
+{
+    float reward = 0.0f;
+    bool done = false;          // landed, crashed, or ran out of time
+    bool timed_out = false;     // done only because of MAX_EPISODE_FRAMES
+};
+
+// Lunar Lander without a window.
+//
+// step() is one FIXED_TIMESTEP of the game's update() for one frame of held
+// arrow keys, with the same numbers Entity::update uses, but over plain data:
+// nothing here touches SDL or OpenGL, so training jobs can run it anywhere
+// and as fast as the CPU allows.
+class LanderEnv
+{
+private:
+    LanderState m_state;
+    float m_potential = 0.0f;
+    const Level *m_level = nullptr;
+
+    // Entity::check_collision_y / _x against one box, for a lander of
+    // PLAYER_SIZE; true if it was pushed back out
+    static bool collide_y(LanderState *state, const glm::vec3 &position, float width, float height, bool *bottom);
+    static bool collide_x(LanderState *state, const glm::vec3 &position, float width, float height);
+
+    // The thrusters' part of Entity::update: the acceleration for the keys
+    // held, and the energy that burns
+    static void thrust(LanderState *state, unsigned char input);
+
+    // Entity::update of the player against one set of boxes. Sets bottom if
+    // it landed on one and side if it hit one from the left or right.
+    static void move(LanderState *state, unsigned char input, const glm::vec3 *positions, float width, float height,
+                     int count, bool *bottom, bool *side);
+
+    // Entity::update of the player against a Level. Sets landed if it came
+    // down on a pad and crashed if it hit any terrain.
+    static void move(LanderState *state, unsigned char input, const Level &level, bool *landed, bool *crashed);
+
+    // The pad the lander is making for: its middle and its top
+    void const target_pad(float *pad_x, float *pad_top) const;
+    float const potential() const;
+
+public:
+    static constexpr float FIXED_TIMESTEP = 0.0166666f;
+    static constexpr int MAX_EPISODE_FRAMES = 60 * 60;      // a minute of hovering and you are out
+
+    // x, y, x and y velocity, energy left as a fraction, and the offsets from
+    // the lander's bottom to the middle of the top of the ground (or of the
+    // nearest pad, on a generated level)
+    static constexpr int OBSERVATION_SIZE = 7;
+    static constexpr int ACTION_COUNT = 16;                 // every combination of LanderInputBits
+
+    static constexpr float WIN_REWARD = 100.0f;
+    static constexpr float LOSE_REWARD = -100.0f;
+
+    // The shaping term of the reward: closer to the middle of the pad's top
+    // and slower is better. Inline so that LanderBatch's kernel computes it the
+    // same way, to the bit.
+    static float potential(float x, float y, float velocity_x, float velocity_y,
+                           float pad_x = GROUND_POSITION.x, float pad_top = GROUND_POSITION.y + GROUND_HEIGHT / 2.0f)
+    {
+        float offset_x = pad_x - x;
+        float offset_y = pad_top + PLAYER_SIZE / 2.0f - y;
+        return -std::sqrt(offset_x * offset_x + offset_y * offset_y)
+               - 0.5f * std::sqrt(velocity_x * velocity_x + velocity_y * velocity_y);
+    }
+
+    // xorshift32, as in Pong's PongSim, and a float in [min, max] from it
+    static unsigned int next_random(unsigned int *random_state);
+    static float random_between(unsigned int *random_state, float min, float max);
+
+    // Seed 0 starts exactly where the game does; any other seed moves the
+    // start along the top of the screen and gives the lander a little drift
+    void reset(unsigned int seed = 0);
+
+    // Plays on a generated level instead of the hand-placed one (nullptr goes
+    // back to it) from the next reset on. The level has to outlive the env.
+    void set_level(const Level *level) { m_level = level; }
+    LanderStep step(unsigned char input);
+
+    void observe(float *observation) const;
+
+    const LanderState &get_state() const { return m_state; }
+    void set_state(const LanderState &new_state) { m_state = new_state; m_potential = potential(); }
+};
@@ -0,0 +1,108 @@
+#include "Level.h"
+#include <algorithm>
+#include "LanderEnv.h"
+
+void Level::clear()
+{
+    m_left.clear();
+    m_x.clear();
+    m_y.clear();
+    m_width.clear();
+    m_height.clear();
+    m_kind.clear();
+    m_pads.clear();
+    m_max_width = 0.0f;
+    m_left_edge = m_right_edge = 0.0f;
+}
+
+void Level::add(float x, float y, float width, float height, LevelBoxKind kind)
+{
+    m_left.push_back(x - width / 2.0f);
+    m_x.push_back(x);
+    m_y.push_back(y);
+    m_width.push_back(width);
+    m_height.push_back(height);
+    m_kind.push_back((unsigned char) kind);
+    m_max_width = std::max(m_max_width, width);
+
+    bool first = m_x.size() == 1;
+    m_left_edge = first ? x - width / 2.0f : std::min(m_left_edge, x - width / 2.0f);
+    m_right_edge = first ? x + width / 2.0f : std::max(m_right_edge, x + width / 2.0f);
+}
+
+void Level::build()
+{
+    const int size = get_size();
+    std::vector<int> order(size);
+    for (int i = 0; i < size; i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) { return m_left[a] < m_left[b]; });
+
+    Level sorted;
+    for (int box : order) sorted.add(m_x[box], m_y[box], m_width[box], m_height[box], (LevelBoxKind) m_kind[box]);
+    *this = sorted;
+
+    for (int box = 0; box < size; box++)
+        if (m_kind[box] == LEVEL_PAD) m_pads.push_back(box);
+}
+
+void Level::generate(unsigned int seed, float left, float right, float floor, int pad_count)
+{
+    clear();
+    unsigned int random_state = seed == 0 ? 1 : seed;
+
+    // One pad somewhere in the middle of each of pad_count equal stretches
+    std::vector<float> pad_left;
+    float stretch = (right - left) / std::max(pad_count, 1);
+    for (int i = 0; i < pad_count && stretch >= PAD_WIDTH; i++)
+        pad_left.push_back(left + stretch * i + LanderEnv::random_between(&random_state, 0.0f, stretch - PAD_WIDTH));
+
+    // Terrain columns from left to right, their tops a random walk, cut short
+    // where a pad starts
+    const float lowest = floor + 0.3f, highest = floor + 1.7f;
+    float top = LanderEnv::random_between(&random_state, lowest, highest);
+    float x = left;
+    int next_pad = 0;
+    while (x < right) {
+        if (next_pad < (int) pad_left.size() && x >= pad_left[next_pad]) {
+            float pad_top = LanderEnv::random_between(&random_state, lowest, (lowest + highest) / 2.0f);
+            add(x + PAD_WIDTH / 2.0f, (floor + pad_top) / 2.0f, PAD_WIDTH, pad_top - floor, LEVEL_PAD);
+            x += PAD_WIDTH;
+            next_pad++;
+            continue;
+        }
+
+        float width = LanderEnv::random_between(&random_state, 0.5f, 1.2f);
+        float column_top = std::min(std::max(top + LanderEnv::random_between(&random_state, -0.6f, 0.6f), lowest), highest);
+        top = column_top;
+
+        // now and then a narrow spire, to be flown around
+        if (LanderEnv::next_random(&random_state) % 10 == 0) {
+            width = LanderEnv::random_between(&random_state, 0.4f, 0.7f);
+            column_top = floor + LanderEnv::random_between(&random_state, 2.5f, 3.5f);
+        }
+
+        float end = std::min(x + width, right);
+        if (next_pad < (int) pad_left.size()) end = std::min(end, pad_left[next_pad]);
+        add((x + end) / 2.0f, (floor + column_top) / 2.0f, end - x, column_top - floor, LEVEL_TERRAIN);
+        x = end;
+    }
+
+    build();
+}
+
+void const Level::query(float left, float right, int *first, int *last) const
+{
+    *first = (int) (std::lower_bound(m_left.begin(), m_left.end(), left - m_max_width) - m_left.begin());
+    *last = (int) (std::lower_bound(m_left.begin() + *first, m_left.end(), right) - m_left.begin());
+}
+
+int const Level::nearest_pad(float x) const
+{
+    if (m_pads.empty()) return -1;
+
+    // Pads don't overlap, so their middles are in order too
+    auto after = std::lower_bound(m_pads.begin(), m_pads.end(), x, [this](int pad, float value) { return m_x[pad] < value; });
+    if (after == m_pads.begin()) return *after;
+    if (after == m_pads.end()) return m_pads.back();
+    return x - m_x[*(after - 1)] <= m_x[*after] - x ? *(after - 1) : *after;
+}
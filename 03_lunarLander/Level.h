@@ -0,0 +1,55 @@
+#pragma once
+#include <vector>
+
+enum LevelBoxKind : unsigned char { LEVEL_TERRAIN, LEVEL_PAD };
+
+constexpr float PAD_WIDTH = 2.0f;               // twice the lander, like the hand-placed ground's gap
+
+// The solid parts of a lander level: axis-aligned boxes, each either terrain
+// (touching it is a crash) or a pad (landing on top of it is a win).
+//
+// The boxes are kept as flat arrays sorted by their left edge, so finding
+// those that might overlap a span of x is two binary searches instead of a
+// pass over the whole level: a box can only reach the span if its left edge
+// is after the span's left minus the widest box, and before the span's right.
+class Level
+{
+private:
+    std::vector<float> m_left;                  // sorted
+    std::vector<float> m_x, m_y;                // centres
+    std::vector<float> m_width, m_height;
+    std::vector<unsigned char> m_kind;
+    std::vector<int> m_pads;                    // indices of the pads, left to right
+
+    float m_max_width = 0.0f;
+    float m_left_edge = 0.0f, m_right_edge = 0.0f;
+
+public:
+    void clear();
+
+    // Boxes can be added in any order; build() sorts them and must be called
+    // before querying
+    void add(float x, float y, float width, float height, LevelBoxKind kind);
+    void build();
+
+    // A seeded layout of terrain columns between left and right, standing on
+    // floor, with pad_count flat pads spread along it and the odd tall spire
+    void generate(unsigned int seed, float left, float right, float floor, int pad_count);
+
+    // The range [*first, *last) of boxes that might overlap (left, right) in
+    // x; the caller still tests each one
+    void const query(float left, float right, int *first, int *last) const;
+
+    // The pad whose middle is nearest x, or -1 if there are none
+    int const nearest_pad(float x) const;
+
+    int const get_size() const { return (int) m_x.size(); }
+    int const get_pad_count() const { return (int) m_pads.size(); }
+    float const get_x(int box) const { return m_x[box]; }
+    float const get_y(int box) const { return m_y[box]; }
+    float const get_width(int box) const { return m_width[box]; }
+    float const get_height(int box) const { return m_height[box]; }
+    LevelBoxKind const get_kind(int box) const { return (LevelBoxKind) m_kind[box]; }
+    float const get_left_edge() const { return m_left_edge; }
+    float const get_right_edge() const { return m_right_edge; }
+};
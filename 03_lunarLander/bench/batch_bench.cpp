@@ -0,0 +1,130 @@
+//
+//  batch_bench.cpp
+//  03_lunarLander
+//
+//  First steps a LanderBatch next to one LanderEnv per lane on the same random
+//  inputs, resetting the single envs with the seeds the batch hands out, and
+//  checks every lane's state and reward agree to the bit. Then measures
+//  env-steps per second for batches of increasing size against stepping
+//  LanderEnvs one at a time.
+//
+//  Usage: batch_bench [env_steps_per_size]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "LanderBatch.h"
+#include "LanderEnv.h"
+
+unsigned int next_random(unsigned int *random_state)
+{
+    unsigned int x = *random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *random_state = x;
+    return x;
+}
+
+// A few steps' worth of random inputs per lane, cycled through so that
+// generating them stays out of the timings
+std::vector<unsigned char> random_inputs(int count)
+{
+    std::vector<unsigned char> inputs(count);
+    unsigned int random_state = 12345;
+    for (unsigned char &input : inputs) input = (unsigned char) ((next_random(&random_state) >> 8) % LanderEnv::ACTION_COUNT);
+    return inputs;
+}
+
+constexpr int INPUT_BLOCKS = 16;
+
+bool same_bits(float a, float b) { return memcmp(&a, &b, sizeof(float)) == 0; }
+
+bool matches_single_envs(int size, int step_count)
+{
+    LanderBatch batch(size, 1);
+    std::vector<LanderEnv> envs(size);
+    for (int lane = 0; lane < size; lane++) envs[lane].reset(batch.get_seed(lane));
+
+    std::vector<unsigned char> inputs = random_inputs(size * INPUT_BLOCKS);
+    std::vector<float> rewards(size);
+    std::vector<unsigned char> outcomes(size);
+
+    for (int step = 0; step < step_count; step++) {
+        const unsigned char *step_inputs = inputs.data() + (step % INPUT_BLOCKS) * size;
+        batch.step(step_inputs, rewards.data(), outcomes.data());
+
+        for (int lane = 0; lane < size; lane++) {
+            LanderStep single = envs[lane].step(step_inputs[lane]);
+            if (!same_bits(single.reward, rewards[lane]) || single.done != (outcomes[lane] != LANDER_RUNNING)) {
+                printf("lane %d differs on step %d\n", lane, step);
+                return false;
+            }
+            if (single.done) envs[lane].reset(batch.get_seed(lane));
+
+            const LanderState &expected = envs[lane].get_state();
+            LanderState actual = batch.get_state(lane);
+            if (expected.frame != actual.frame || expected.position != actual.position ||
+                expected.velocity != actual.velocity || !same_bits(expected.energy, actual.energy)) {
+                printf("lane %d state differs after step %d\n", lane, step);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+double batch_rate(int size, long long env_steps)
+{
+    LanderBatch batch(size, 1);
+    std::vector<unsigned char> inputs = random_inputs(size * INPUT_BLOCKS);
+    std::vector<float> rewards(size);
+    std::vector<unsigned char> outcomes(size);
+
+    long long step_count = env_steps / size;
+    auto start = std::chrono::steady_clock::now();
+    for (long long step = 0; step < step_count; step++)
+        batch.step(inputs.data() + (step % INPUT_BLOCKS) * size, rewards.data(), outcomes.data());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return step_count * size / seconds;
+}
+
+double single_rate(int size, long long env_steps)
+{
+    std::vector<LanderEnv> envs(size);
+    for (int lane = 0; lane < size; lane++) envs[lane].reset(lane + 1);
+    unsigned int next_seed = size + 1;
+    std::vector<unsigned char> inputs = random_inputs(size * INPUT_BLOCKS);
+
+    long long step_count = env_steps / size;
+    auto start = std::chrono::steady_clock::now();
+    for (long long step = 0; step < step_count; step++) {
+        const unsigned char *step_inputs = inputs.data() + (step % INPUT_BLOCKS) * size;
+        for (int lane = 0; lane < size; lane++)
+            if (envs[lane].step(step_inputs[lane]).done) envs[lane].reset(next_seed++);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    return step_count * size / seconds;
+}
+
+int main(int argc, char* argv[])
+{
+    long long env_steps = argc > 1 ? atoll(argv[1]) : 50000000;
+
+    bool matches = matches_single_envs(64, 20000);
+    printf("batch against single envs: %s\n", matches ? "same" : "DIFFERENT");
+
+    const int sizes[] = { 1, 16, 256, 4096, 65536 };
+    printf("   lanes  batch M steps/s  single M steps/s  speedup\n");
+    for (int size : sizes) {
+        double batch = batch_rate(size, env_steps), single = single_rate(size, env_steps);
+        printf("%8d  %15.1f  %16.1f  %6.1fx\n", size, batch / 1e6, single / 1e6, batch / single);
+    }
+
+    return matches ? 0 : 2;
+}
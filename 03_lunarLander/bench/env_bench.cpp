@@ -0,0 +1,115 @@
+//
+//  env_bench.cpp
+//  03_lunarLander
+//
+//  Runs LanderEnv headlessly with two policies, random key presses and a
+//  simple controller that steers over the ground and brakes on the way down,
+//  resetting each finished episode with a fresh seed. Reports steps per
+//  second, episodes and how they ended, then replays one episode to check it
+//  comes out the same.
+//
+//  Usage: env_bench [steps]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "LanderEnv.h"
+
+unsigned char random_policy(const float *, unsigned int *random_state)
+{
+    unsigned int x = *random_state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *random_state = x;
+    return (unsigned char) ((x >> 8) % LanderEnv::ACTION_COUNT);
+}
+
+unsigned char controller_policy(const float *observation, unsigned int *)
+{
+    float offset_x = observation[5];
+    float velocity_x = observation[2], velocity_y = observation[3];
+
+    unsigned char input = 0;
+    float target_velocity_x = offset_x * 0.5f;
+    if (velocity_x < target_velocity_x - 0.05f) input |= LANDER_RIGHT;
+    if (velocity_x > target_velocity_x + 0.05f) input |= LANDER_LEFT;
+
+    // hold height until over the ground, since the forests either side of it
+    // stand taller than it, then come down
+    float target_velocity_y = offset_x > 0.3f || offset_x < -0.3f ? 0.0f : -0.3f;
+    if (velocity_y < target_velocity_y) input |= LANDER_UP;
+    return input;
+}
+
+struct Result
+{
+    long long steps = 0;
+    int wins = 0, losses = 0, timeouts = 0;
+    double reward = 0.0;
+    double seconds = 0.0;
+};
+
+template <typename Policy>
+Result run(long long step_count, Policy policy)
+{
+    LanderEnv env;
+    unsigned int seed = 1, policy_state = 12345;
+    env.reset(seed);
+
+    float observation[LanderEnv::OBSERVATION_SIZE];
+    Result result;
+
+    auto start = std::chrono::steady_clock::now();
+    for (; result.steps < step_count; result.steps++) {
+        env.observe(observation);
+        LanderStep step = env.step(policy(observation, &policy_state));
+        result.reward += step.reward;
+        if (!step.done) continue;
+
+        if (step.timed_out) result.timeouts++;
+        else if (env.get_state().result == WIN) result.wins++;
+        else result.losses++;
+        env.reset(++seed);
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+void report(const char *name, const Result &result)
+{
+    int episodes = result.wins + result.losses + result.timeouts;
+    printf("%-10s  %8.2f M steps/s  %7d episodes  %5.1f%% won  %5.1f%% lost  %5.1f%% timed out  %8.2f mean return\n",
+           name, result.steps / result.seconds / 1e6, episodes,
+           100.0 * result.wins / episodes, 100.0 * result.losses / episodes, 100.0 * result.timeouts / episodes,
+           result.reward / episodes);
+}
+
+// One controller episode from a seed, as the final state
+LanderState play(unsigned int seed)
+{
+    LanderEnv env;
+    env.reset(seed);
+
+    float observation[LanderEnv::OBSERVATION_SIZE];
+    for (;;) {
+        env.observe(observation);
+        if (env.step(controller_policy(observation, nullptr)).done) return env.get_state();
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    long long step_count = argc > 1 ? atoll(argv[1]) : 20000000;
+
+    report("random", run(step_count, random_policy));
+    report("controller", run(step_count, controller_policy));
+
+    LanderState first = play(42), second = play(42);
+    bool same = first.frame == second.frame && first.result == second.result &&
+                first.position == second.position && first.energy == second.energy;
+    printf("replay: %s\n", same ? "same" : "DIFFERENT");
+
+    return same ? 0 : 2;
+}
@@ -0,0 +1,100 @@
+//
+//  level_bench.cpp
+//  03_lunarLander
+//
+//  Generates seeded levels from one screen wide to thousands, checks that
+//  Level::query finds every box a lander-sized span overlaps (against testing
+//  them all), and times the query against that full scan. Then flies
+//  LanderEnv over generated levels on random inputs to show the steps per
+//  second hold up as the level grows.
+//
+//  Usage: level_bench [queries]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "Level.h"
+#include "LanderEnv.h"
+
+constexpr float FLOOR = -3.75f;
+
+bool overlaps(const Level &level, int box, float left, float right)
+{
+    float box_left = level.get_x(box) - level.get_width(box) / 2.0f;
+    return box_left < right && box_left + level.get_width(box) > left;
+}
+
+// Both ways of finding the boxes under each span, counted so neither can be
+// optimised away; false if they disagree
+bool compare(const Level &level, const std::vector<float> &spans, double *query_ns, double *scan_ns)
+{
+    const float half = PLAYER_SIZE / 2.0f;
+    long long query_found = 0, scan_found = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (float x : spans) {
+        int first, last;
+        level.query(x - half, x + half, &first, &last);
+        for (int box = first; box < last; box++) query_found += overlaps(level, box, x - half, x + half);
+    }
+    auto middle = std::chrono::steady_clock::now();
+    for (float x : spans)
+        for (int box = 0; box < level.get_size(); box++) scan_found += overlaps(level, box, x - half, x + half);
+    auto end = std::chrono::steady_clock::now();
+
+    *query_ns = std::chrono::duration<double, std::nano>(middle - start).count() / spans.size();
+    *scan_ns = std::chrono::duration<double, std::nano>(end - middle).count() / spans.size();
+    return query_found == scan_found;
+}
+
+double env_rate(const Level &level, long long step_count, int *wins, int *episodes)
+{
+    LanderEnv env;
+    env.set_level(&level);
+    unsigned int seed = 1, random_state = 12345;
+    env.reset(seed);
+
+    *wins = *episodes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long long step = 0; step < step_count; step++) {
+        unsigned char input = (unsigned char) ((LanderEnv::next_random(&random_state) >> 8) % LanderEnv::ACTION_COUNT);
+        if (!env.step(input).done) continue;
+
+        (*episodes)++;
+        *wins += env.get_state().result == WIN;
+        env.reset(++seed);
+    }
+    return step_count / std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    int query_count = argc > 1 ? atoi(argv[1]) : 20000;
+
+    const float widths[] = { 10.0f, 100.0f, 1000.0f, 10000.0f };
+    printf("   width    boxes   pads  query ns  scan ns  M env steps/s  landed\n");
+
+    bool all_agree = true;
+    for (float width : widths) {
+        Level level;
+        level.generate(7, -width / 2.0f, width / 2.0f, FLOOR, (int) (width / 5.0f));
+
+        unsigned int random_state = 99;
+        std::vector<float> spans(query_count);
+        for (float &x : spans) x = LanderEnv::random_between(&random_state, level.get_left_edge(), level.get_right_edge());
+
+        double query_ns, scan_ns;
+        bool agree = compare(level, spans, &query_ns, &scan_ns);
+        all_agree = all_agree && agree;
+
+        int wins, episodes;
+        double rate = env_rate(level, 2000000, &wins, &episodes);
+
+        printf("%8.0f  %7d  %5d  %8.1f  %7.0f  %13.1f  %5.1f%%  %s\n", width, level.get_size(), level.get_pad_count(),
+               query_ns, scan_ns, rate / 1e6, 100.0 * wins / episodes, agree ? "" : "MISSED BOXES");
+    }
+
+    return all_agree ? 0 : 2;
+}
@@ -12,9 +12,7 @@
 #define STB_IMAGE_IMPLEMENTATION
 #define LOG(argument) std::cout << argument << '\n'
 #define GL_GLEXT_PROTOTYPES 1
-#define FIXED_TIMESTEP 0.0166666f
 #define GROUND_COUNT 1
-#define FOREST_COUNT 2
 
 #ifdef _WINDOWS
 #include <GL/glew.h>
@@ -28,12 +26,15 @@
 #include "stb_image.h"
 #include "cmath"
 #include <ctime>
+#include <cstring>
+#include <cstdlib>
 #include <vector>
 #include "Entity.h"
+#include "LanderEnv.h"
+#include "Level.h"
 
 //  STRUCTS AND ENUMS  //
 enum AppStatus { RUNNING, TERMINATED };
-enum GameResult { WIN, LOSE, NONE };
 
 struct GameState
 {
@@ -70,15 +71,13 @@ constexpr int NUMBER_OF_TEXTURES = 1;
 constexpr GLint LEVEL_OF_DETAIL = 0;
 constexpr GLint TEXTURE_BORDER = 0;
 
-constexpr float FOREST_HEIGHT = 2.0f;
-constexpr float FOREST_WIDTH = 1280 / 374.0f * FOREST_HEIGHT; //6.84
-constexpr float GROUND_HEIGHT = 0.48f;
-constexpr float GROUND_WIDTH = 360 / 78.0f * GROUND_HEIGHT; //2.22
-
 constexpr int FONTBANK_SIZE = 16;
 
-//constexpr int ENERGY_MAX = 300;
-constexpr float ENERGY_MAX = 400.0f;
+// --level: a generated level across the screen, standing on its bottom edge
+constexpr float LEVEL_LEFT = -5.0f,
+LEVEL_RIGHT = 5.0f,
+LEVEL_FLOOR = -3.75f;
+constexpr int LEVEL_PAD_COUNT = 2;
 
 //  GLOBAL VARIABLES  //
 GameState g_game_state;
@@ -95,13 +94,15 @@ GLuint g_font_texture_id;
 
 float g_previous_ticks = 0.0f;
 float g_accumulator = 0.0f;
-//int g_energy = ENERGY_MAX;
-float g_energy = ENERGY_MAX;
+
+Level* g_level = nullptr;           // set by --level, in place of the forests and the ground
+Entity* g_level_boxes = nullptr;    // to draw it
 
 //  GENERAL FUNCTIONS  //
 GLuint load_texture(const char* filepath);
 
 void initialise();
+void generate_level(unsigned int seed);
 void process_input();
 void update();
 void render();
@@ -150,7 +151,7 @@ void draw_text(ShaderProgram* program, GLuint font_texture_id, std::string text,
     std::vector<float> texture_coordinates;
 
     // For every character...
-    for (int i = 0; i < text.size(); i++) {
+    for (size_t i = 0; i < text.size(); i++) {
         // 1. Get their index in the spritesheet, as well as their offset (i.e. their
         //    position relative to the whole sentence)
         int spritesheet_index = (int)text[i];  // ascii value of character
@@ -243,7 +244,7 @@ void initialise()
     g_game_state.player = new Entity(
         player_texture_id,         // texture id
         1.0f,                      // speed
-        glm::vec3(0.0f, -0.05f, 0.0f),   // acceleration
+        glm::vec3(0.0f, GRAVITY, 0.0f),   // acceleration
         0.0f,   // jump power
         player_animation,
         0.0f,   //animation time
@@ -255,9 +256,10 @@ void initialise()
         0.5f                       // height
     );
 
-    g_game_state.player->set_position(glm::vec3(-4.0f, 2.5f, 0.0f));
-    g_game_state.player->set_scale(glm::vec3(1.f, 1.f, 0.0f));
+    g_game_state.player->set_position(PLAYER_INIT_POS);
+    g_game_state.player->set_scale(glm::vec3(PLAYER_SIZE, PLAYER_SIZE, 0.0f));
     g_game_state.player->face_down();
+    g_game_state.player->set_thrusters(glm::vec3(0.0f, GRAVITY, 0.0f), ENERGY_MAX);
 
     //  FOREST  //
     g_game_state.forests = new Entity[FOREST_COUNT];
@@ -272,7 +274,7 @@ void initialise()
             FOREST_HEIGHT               // height
         );
 
-        g_game_state.forests[i].set_position(glm::vec3(-4.0f + 9.0f * i, -3.1f, 0.0f));
+        g_game_state.forests[i].set_position(FOREST_POSITIONS[i]);
         g_game_state.forests[i].set_scale(glm::vec3(FOREST_WIDTH, FOREST_HEIGHT, 0.0f));
     }
     g_game_state.forests[1].set_rotation(glm::vec3(0.0f, glm::radians(180.0f), 0.0f));
@@ -289,7 +291,7 @@ void initialise()
         GROUND_HEIGHT                       // height
     );
 
-    g_game_state.ground->set_position(glm::vec3(0.5f, -3.5f, 0.0f));
+    g_game_state.ground->set_position(GROUND_POSITION);
     g_game_state.ground->set_scale(glm::vec3(GROUND_WIDTH, GROUND_HEIGHT, 0.0f));
 
     // ----- FONT -----//
@@ -300,9 +302,26 @@ void initialise()
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 }
 
+void generate_level(unsigned int seed)
+{
+    g_level = new Level();
+    g_level->generate(seed, LEVEL_LEFT, LEVEL_RIGHT, LEVEL_FLOOR, LEVEL_PAD_COUNT);
+
+    // Pads are drawn as the ground and terrain as the forest, stretched
+    g_level_boxes = new Entity[g_level->get_size()];
+    for (int i = 0; i < g_level->get_size(); i++) {
+        GLuint texture_id = g_level->get_kind(i) == LEVEL_PAD ? g_game_state.ground->get_texture_id()
+                                                               : g_game_state.forests[0].get_texture_id();
+        g_level_boxes[i] = Entity(texture_id, 0.0f, glm::vec3(0.0f), g_level->get_width(i), g_level->get_height(i));
+        g_level_boxes[i].set_position(glm::vec3(g_level->get_x(i), g_level->get_y(i), 0.0f));
+        g_level_boxes[i].set_scale(glm::vec3(g_level->get_width(i), g_level->get_height(i), 0.0f));
+        g_level_boxes[i].update(0.0f, NULL, 0);
+    }
+}
+
 void process_input()
 {
-    g_game_state.player->set_acceleration(glm::vec3(0.0f, -0.02f, 0.0f));
+    g_game_state.player->set_thrust(glm::vec3(0.0f));
 
     SDL_Event event;
     while (SDL_PollEvent(&event))
@@ -332,25 +351,20 @@ void process_input()
 
     const Uint8* key_state = SDL_GetKeyboardState(NULL);
 
-    if (g_energy > 0) {
-        if (key_state[SDL_SCANCODE_LEFT]) {
-            g_game_state.player->move_left();
-            g_energy-=0.01;
-        }
-        else if (key_state[SDL_SCANCODE_RIGHT]) {
-            g_game_state.player->move_right();
-            g_energy-=0.01;
-        }
-
-        if (key_state[SDL_SCANCODE_UP]) {
-            g_game_state.player->move_up();
-            g_energy-=0.01;
-        }
-        else if (key_state[SDL_SCANCODE_DOWN]) {
-            g_game_state.player->move_down();
-            g_energy-=0.01;
-        }
+    // Only which keys are held; the fixed-step update turns them into thrust
+    // and burns the energy
+    if (key_state[SDL_SCANCODE_LEFT]) {
+        g_game_state.player->move_left();
+    }
+    else if (key_state[SDL_SCANCODE_RIGHT]) {
+        g_game_state.player->move_right();
+    }
 
+    if (key_state[SDL_SCANCODE_UP]) {
+        g_game_state.player->move_up();
+    }
+    else if (key_state[SDL_SCANCODE_DOWN]) {
+        g_game_state.player->move_down();
     }
 
     if (glm::length(g_game_state.player->get_movement()) > 1.0f)
@@ -366,22 +380,35 @@ void update()
 
         delta_time += g_accumulator;
 
-        if (delta_time < FIXED_TIMESTEP)
+        if (delta_time < LanderEnv::FIXED_TIMESTEP)
         {
             g_accumulator = delta_time;
             return;
         }
 
-        while (delta_time >= FIXED_TIMESTEP)
+        while (delta_time >= LanderEnv::FIXED_TIMESTEP)
         {
-            g_game_state.player->update(FIXED_TIMESTEP, g_game_state.forests, FOREST_COUNT);
+            if (g_level) {
+                g_game_state.player->update(LanderEnv::FIXED_TIMESTEP, g_level);
+                if (g_game_state.player->get_collided_terrain()) {
+                    g_game_result = LOSE;
+                }
+                if (g_game_state.player->get_landed_on_pad()) {
+                    g_game_result = WIN;
+                }
+
+                delta_time -= LanderEnv::FIXED_TIMESTEP;
+                continue;
+            }
+
+            g_game_state.player->update(LanderEnv::FIXED_TIMESTEP, g_game_state.forests, FOREST_COUNT);
             if (g_game_state.player->get_collided_bottom() ||
                 g_game_state.player->get_collided_left() ||
                 g_game_state.player->get_collided_right()) {
                 g_game_result = LOSE;
             }
 
-            g_game_state.player->update(FIXED_TIMESTEP, g_game_state.ground, GROUND_COUNT);
+            g_game_state.player->update(LanderEnv::FIXED_TIMESTEP, g_game_state.ground, GROUND_COUNT);
 
             if (g_game_state.player->get_collided_bottom()) {
                 g_game_result = WIN;
@@ -391,13 +418,13 @@ void update()
 
             g_game_state.ground->update(0.0f, NULL, 0);
 
-            delta_time -= FIXED_TIMESTEP;
+            delta_time -= LanderEnv::FIXED_TIMESTEP;
         }
         // when player is outside of the screen
-        if (g_game_state.player->get_position().x < -5.5f ||
-            g_game_state.player->get_position().x > 5.5f ||
-            g_game_state.player->get_position().y < -4.5f ||
-            g_game_state.player->get_position().y > 4.5f) {
+        if (g_game_state.player->get_position().x < -OUT_OF_BOUNDS_X ||
+            g_game_state.player->get_position().x > OUT_OF_BOUNDS_X ||
+            g_game_state.player->get_position().y < -OUT_OF_BOUNDS_Y ||
+            g_game_state.player->get_position().y > OUT_OF_BOUNDS_Y) {
             g_game_result = LOSE;
         }
 
@@ -409,7 +436,7 @@ void render()
 {
     glClear(GL_COLOR_BUFFER_BIT);
 
-    draw_text(&g_shader_program, g_font_texture_id, "Energy: " + std::to_string((int)g_energy), 0.4f, -0.15f,
+    draw_text(&g_shader_program, g_font_texture_id, "Energy: " + std::to_string((int)g_game_state.player->get_energy()), 0.4f, -0.15f,
         glm::vec3(2.2f, 3.5f, 0.0f));
 
     if (g_game_result == WIN) {
@@ -424,10 +451,16 @@ void render()
 
     g_game_state.player->render(&g_shader_program);
 
-    for (int i = 0; i < FOREST_COUNT; i++)
-        g_game_state.forests[i].render(&g_shader_program);
+    if (g_level) {
+        for (int i = 0; i < g_level->get_size(); i++)
+            g_level_boxes[i].render(&g_shader_program);
+    }
+    else {
+        for (int i = 0; i < FOREST_COUNT; i++)
+            g_game_state.forests[i].render(&g_shader_program);
 
-    g_game_state.ground->render(&g_shader_program);
+        g_game_state.ground->render(&g_shader_program);
+    }
 
     SDL_GL_SwapWindow(g_display_window);
 }
@@ -439,6 +472,8 @@ void shutdown()
     delete[] g_game_state.forests;
     delete g_game_state.player;
     delete g_game_state.ground;
+    delete[] g_level_boxes;
+    delete g_level;
 }
 
 //  GAME LOOP  //
@@ -446,6 +481,9 @@ int main(int argc, char* argv[])
 {
     initialise();
 
+    if (argc > 2 && strcmp(argv[1], "--level") == 0)
+        generate_level((unsigned int) strtoul(argv[2], NULL, 10));
+
     while (g_app_status == RUNNING)
     {
         process_input();
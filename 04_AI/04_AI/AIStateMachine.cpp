@@ -0,0 +1,238 @@
+//
+//  AIStateMachine.cpp
+//  04_AI
+//
+
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "AIStateMachine.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+namespace
+{
+    const char *AI_TYPE_NAMES[AI_TYPE_COUNT]   = { "WALKER", "GUARD", "FLYER", "SHOOTER", "BULLET", "NOTYPE" };
+    const char *AI_STATE_NAMES[AI_STATE_COUNT] = { "WALKING", "IDLE", "ATTACKING", "NOSTATE" };
+    const char *ACTION_NAMES[]    = { "none", "stop", "chase", "fly", "bullet" };
+    const char *PREDICATE_NAMES[] = { "always", "player_within", "player_beyond" };
+
+    int find_name(const char *const *names, int name_count, const std::string &name)
+    {
+        for (int i = 0; i < name_count; i++)
+            if (name == names[i]) return i;
+        return -1;
+    }
+}
+
+AIStateMachine::AIStateMachine()
+    : m_batch_start(AI_TYPE_COUNT * AI_STATE_COUNT + 1, 0), m_batch_cursor(AI_TYPE_COUNT * AI_STATE_COUNT, 0) { }
+
+void AIStateMachine::clear()
+{
+    for (int type = 0; type < AI_TYPE_COUNT; type++)
+        for (int state = 0; state < AI_STATE_COUNT; state++) m_rows[type][state] = AIStateRow();
+    m_transitions.clear();
+}
+
+bool AIStateMachine::load(const char *filepath)
+{
+    clear();
+
+    std::ifstream infile(filepath);
+    if (infile.fail())
+    {
+        LOG("Unable to open AI table " << filepath << ".");
+        return false;
+    }
+
+    // Transitions are read in file order but stored grouped by their source row,
+    // so we collect them first and lay them out once the whole table is known
+    struct PendingTransition { int type, from; AITransition transition; };
+    std::vector<PendingTransition> pending;
+
+    int current_type = -1;
+    int line_number  = 0;
+    std::string line;
+
+    while (std::getline(infile, line))
+    {
+        line_number++;
+        std::istringstream tokens(line);
+        std::string keyword;
+        if (!(tokens >> keyword) || keyword[0] == '#') continue;
+
+        if (keyword == "machine")
+        {
+            std::string type_name;
+            tokens >> type_name;
+            current_type = find_name(AI_TYPE_NAMES, AI_TYPE_COUNT, type_name);
+        }
+        else if (keyword == "state" && current_type >= 0)
+        {
+            std::string state_name, action_name;
+            tokens >> state_name >> action_name;
+            int state  = find_name(AI_STATE_NAMES, AI_STATE_COUNT, state_name);
+            int action = find_name(ACTION_NAMES, (int) (sizeof(ACTION_NAMES) / sizeof(*ACTION_NAMES)), action_name);
+            if (state < 0 || action < 0)
+            {
+                LOG("AI table " << filepath << ":" << line_number << ": unknown state or action.");
+                clear();
+                return false;
+            }
+            m_rows[current_type][state].is_defined = true;
+            m_rows[current_type][state].action     = (AIAction) action;
+        }
+        else if (keyword == "transition" && current_type >= 0)
+        {
+            std::string from_name, to_name, predicate_name;
+            float argument = 0.0f;
+            tokens >> from_name >> to_name >> predicate_name >> argument;
+            int from      = find_name(AI_STATE_NAMES, AI_STATE_COUNT, from_name);
+            int to        = find_name(AI_STATE_NAMES, AI_STATE_COUNT, to_name);
+            int predicate = find_name(PREDICATE_NAMES, (int) (sizeof(PREDICATE_NAMES) / sizeof(*PREDICATE_NAMES)), predicate_name);
+            if (from < 0 || to < 0 || predicate < 0)
+            {
+                LOG("AI table " << filepath << ":" << line_number << ": malformed transition.");
+                clear();
+                return false;
+            }
+            pending.push_back({ current_type, from, { (AIState) to, (AIPredicate) predicate, argument } });
+        }
+        else
+        {
+            LOG("AI table " << filepath << ":" << line_number << ": unexpected '" << keyword << "'.");
+            clear();
+            return false;
+        }
+    }
+
+    m_transitions.clear();
+    for (int type = 0; type < AI_TYPE_COUNT; type++)
+    {
+        for (int state = 0; state < AI_STATE_COUNT; state++)
+        {
+            AIStateRow &row = m_rows[type][state];
+            row.first_transition = (int) m_transitions.size();
+            for (const PendingTransition &entry : pending)
+                if (entry.type == type && entry.from == state) m_transitions.push_back(entry.transition);
+            row.transition_count = (int) m_transitions.size() - row.first_transition;
+        }
+    }
+
+    return true;
+}
+
+bool const AIStateMachine::test(AIPredicate predicate, float argument, const Percept &percept) const
+{
+    switch (predicate)
+    {
+        case PLAYER_WITHIN:
+            return percept.distance < argument;
+
+        case PLAYER_BEYOND:
+            return percept.distance > argument;
+
+        case ALWAYS:
+        default:
+            return true;
+    }
+}
+
+void AIStateMachine::run_action(AIAction action, Entity *agents, const int *batch, int batch_size, const Percept *percepts)
+{
+    // One branch per batch instead of one per agent
+    switch (action)
+    {
+        case ACTION_STOP:
+            for (int i = 0; i < batch_size; i++) agents[batch[i]].ai_stop();
+            break;
+
+        case ACTION_CHASE:
+            for (int i = 0; i < batch_size; i++) agents[batch[i]].ai_chase(percepts[batch[i]]);
+            break;
+
+        case ACTION_FLY:
+            for (int i = 0; i < batch_size; i++) agents[batch[i]].ai_fly();
+            break;
+
+        case ACTION_BULLET:
+            for (int i = 0; i < batch_size; i++) agents[batch[i]].ai_bullet(percepts[batch[i]]);
+            break;
+
+        case ACTION_NONE:
+        default:
+            break;
+    }
+}
+
+void AIStateMachine::run_transitions(const AIStateRow &row, Entity *agents, const int *batch, int batch_size, const Percept *percepts)
+{
+    for (int i = 0; i < batch_size; i++)
+    {
+        const Percept &percept = percepts[batch[i]];
+        for (int t = 0; t < row.transition_count; t++)
+        {
+            const AITransition &transition = m_transitions[row.first_transition + t];
+            if (test(transition.predicate, transition.argument, percept))
+            {
+                agents[batch[i]].set_ai_state(transition.to);
+                break;
+            }
+        }
+    }
+}
+
+void AIStateMachine::update(Entity *agents, int agent_count, const Perception &perception, JobSystem *jobs)
+{
+    constexpr int ROW_COUNT = AI_TYPE_COUNT * AI_STATE_COUNT;
+    const Percept *percepts = perception.get_table();
+
+    // Counting sort of the active enemies by (type, state)
+    std::fill(m_batch_start.begin(), m_batch_start.end(), 0);
+    for (int i = 0; i < agent_count; i++)
+    {
+        Entity &agent = agents[i];
+        if (!agent.get_activation_status() || agent.get_entity_type() != ENEMY) continue;
+        m_batch_start[agent.get_ai_type() * AI_STATE_COUNT + agent.get_ai_state() + 1]++;
+    }
+    for (int row = 0; row < ROW_COUNT; row++) m_batch_start[row + 1] += m_batch_start[row];
+
+    m_batch.resize(m_batch_start[ROW_COUNT]);
+    std::copy(m_batch_start.begin(), m_batch_start.end() - 1, m_batch_cursor.begin());
+    for (int i = 0; i < agent_count; i++)
+    {
+        Entity &agent = agents[i];
+        if (!agent.get_activation_status() || agent.get_entity_type() != ENEMY) continue;
+        m_batch[m_batch_cursor[agent.get_ai_type() * AI_STATE_COUNT + agent.get_ai_state()]++] = i;
+    }
+
+    // Each state's action runs as one loop over its batch, then its transitions
+    for (int type = 0; type < AI_TYPE_COUNT; type++)
+    {
+        for (int state = 0; state < AI_STATE_COUNT; state++)
+        {
+            int row_index  = type * AI_STATE_COUNT + state;
+            int *batch     = m_batch.data() + m_batch_start[row_index];
+            int batch_size = m_batch_start[row_index + 1] - m_batch_start[row_index];
+            if (batch_size == 0) continue;
+
+            const AIStateRow &row = m_rows[type][state];
+            auto step_range = [&](int begin, int end)
+            {
+                if (!row.is_defined)
+                {
+                    for (int i = begin; i < end; i++) agents[batch[i]].ai_activate(percepts[batch[i]]);
+                    return;
+                }
+                run_action(row.action, agents, batch + begin, end - begin, percepts);
+                run_transitions(row, agents, batch + begin, end - begin, percepts);
+            };
+
+            if (jobs != nullptr) jobs->parallel_for(batch_size, JOB_GRAIN, step_range);
+            else step_range(0, batch_size);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+//
+//  AIStateMachine.h
+//  04_AI
+//
+
+#pragma once
+#include <vector>
+#include "Entity.h"
+#include "JobSystem.h"
+
+constexpr int AI_TYPE_COUNT  = NOTYPE + 1;
+constexpr int AI_STATE_COUNT = NOSTATE + 1;
+
+// What an agent does while it sits in a state
+enum AIAction    { ACTION_NONE, ACTION_STOP, ACTION_CHASE, ACTION_FLY, ACTION_BULLET };
+
+// What has to be true for a transition to fire
+enum AIPredicate { ALWAYS, PLAYER_WITHIN, PLAYER_BEYOND };
+
+struct AITransition
+{
+    AIState     to;
+    AIPredicate predicate;
+    float       argument;
+};
+
+struct AIStateRow
+{
+    bool     is_defined = false;
+    AIAction action     = ACTION_NONE;
+    int      first_transition = 0;
+    int      transition_count = 0;
+};
+
+class AIStateMachine
+{
+private:
+    // One row per (AIType, AIState) pair; rows that the table does not define
+    // fall back to Entity::ai_activate
+    AIStateRow m_rows[AI_TYPE_COUNT][AI_STATE_COUNT];
+    std::vector<AITransition> m_transitions;
+
+    // Agents bucketed by row, rebuilt every step but never reallocated once warm
+    std::vector<int> m_batch;
+    std::vector<int> m_batch_start;
+    std::vector<int> m_batch_cursor;
+
+    void run_action(AIAction action, Entity *agents, const int *batch, int batch_size, const Percept *percepts);
+    void run_transitions(const AIStateRow &row, Entity *agents, const int *batch, int batch_size, const Percept *percepts);
+    bool const test(AIPredicate predicate, float argument, const Percept &percept) const;
+
+    // Leaves every row undefined so all agents use Entity::ai_activate
+    void clear();
+
+public:
+    AIStateMachine();
+
+    // Reads a table such as assets/ai_machine.txt; returns false (and leaves
+    // the table empty) if the file is missing or malformed
+    bool load(const char *filepath);
+
+    bool const handles(AIType ai_type, AIState ai_state) const { return m_rows[ai_type][ai_state].is_defined; }
+
+    static constexpr int JOB_GRAIN = 256;
+
+    // Runs one AI step for every active enemy, a whole state at a time. With a
+    // job system, each state's batch is split across threads; agents only
+    // write to themselves, so the result is the same either way
+    void update(Entity *agents, int agent_count, const Perception &perception, JobSystem *jobs = nullptr);
+};
@@ -0,0 +1,111 @@
+//
+//  Allocations.cpp
+//  04_AI
+//
+
+#include "Allocations.h"
+#include <atomic>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+// Relaxed: these are statistics, and nothing else is ordered by them
+static std::atomic<long long> g_allocation_count{0};
+static std::atomic<long long> g_allocated_bytes{0};
+static std::atomic<long long> g_free_count{0};
+static std::atomic<long long> g_tag_counts[ALLOCATION_TAG_COUNT];
+static std::atomic<long long> g_tag_bytes[ALLOCATION_TAG_COUNT];
+
+static std::atomic<int> g_check{ALLOCATION_CHECK_OFF};
+static std::atomic<bool> g_is_steady_state{false};
+static std::atomic<long long> g_violation_count{0};
+
+// Constant-initialised, so reading them from operator new is safe on any
+// thread at any point in its life
+static thread_local AllocationTag t_tag = ALLOC_UNTAGGED;
+static thread_local bool t_is_reporting = false;
+
+static const char *const TAG_NAMES[ALLOCATION_TAG_COUNT] =
+{
+    "untagged", "simulation", "ai", "jobs", "snapshots", "input", "render", "text", "assets", "tools"
+};
+
+long long const Allocations::get_count() { return g_allocation_count.load(std::memory_order_relaxed); }
+long long const Allocations::get_bytes() { return g_allocated_bytes.load(std::memory_order_relaxed); }
+long long const Allocations::get_free_count() { return g_free_count.load(std::memory_order_relaxed); }
+
+long long const Allocations::get_count(AllocationTag tag) { return g_tag_counts[tag].load(std::memory_order_relaxed); }
+long long const Allocations::get_bytes(AllocationTag tag) { return g_tag_bytes[tag].load(std::memory_order_relaxed); }
+const char *const Allocations::get_tag_name(AllocationTag tag) { return TAG_NAMES[tag]; }
+
+AllocationTag const Allocations::get_tag() { return t_tag; }
+void Allocations::set_tag(AllocationTag tag) { t_tag = tag; }
+
+// ————— STEADY STATE ————— //
+void Allocations::set_check(AllocationCheck check) { g_check.store(check, std::memory_order_relaxed); }
+void Allocations::set_steady_state(bool is_steady) { g_is_steady_state.store(is_steady, std::memory_order_relaxed); }
+bool const Allocations::is_steady_state() { return g_is_steady_state.load(std::memory_order_relaxed); }
+long long const Allocations::get_violation_count() { return g_violation_count.load(std::memory_order_relaxed); }
+
+// Printed with stdio, which allocates with malloc rather than new; the flag
+// stops it coming back here if it ever does
+static void flag_violation(std::size_t size)
+{
+    long long violation = g_violation_count.fetch_add(1, std::memory_order_relaxed);
+    if (t_is_reporting) return;
+
+    if (violation < Allocations::REPORTED_VIOLATIONS)
+    {
+        t_is_reporting = true;
+        fprintf(stderr, "steady-state allocation: %zu bytes, tagged %s\n", size, TAG_NAMES[t_tag]);
+        t_is_reporting = false;
+    }
+    assert(g_check.load(std::memory_order_relaxed) != ALLOCATION_CHECK_ASSERT && "allocation in the steady-state game loop");
+}
+
+static void *counted_malloc(std::size_t size)
+{
+    g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add((long long) size, std::memory_order_relaxed);
+    g_tag_counts[t_tag].fetch_add(1, std::memory_order_relaxed);
+    g_tag_bytes[t_tag].fetch_add((long long) size, std::memory_order_relaxed);
+
+    if (g_is_steady_state.load(std::memory_order_relaxed) && t_tag != ALLOC_TOOLS &&
+        g_check.load(std::memory_order_relaxed) != ALLOCATION_CHECK_OFF)
+        flag_violation(size);
+
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+static void counted_free(void *pointer)
+{
+    if (!pointer) return;
+    g_free_count.fetch_add(1, std::memory_order_relaxed);
+    std::free(pointer);
+}
+
+// ————— GLOBAL OPERATORS ————— //
+void *operator new(std::size_t size)
+{
+    void *pointer = counted_malloc(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](std::size_t size)
+{
+    void *pointer = counted_malloc(size);
+    if (!pointer) throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return counted_malloc(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return counted_malloc(size); }
+
+void operator delete(void *pointer) noexcept { counted_free(pointer); }
+void operator delete[](void *pointer) noexcept { counted_free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { counted_free(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { counted_free(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { counted_free(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { counted_free(pointer); }
@@ -0,0 +1,85 @@
+//
+//  Allocations.h
+//  04_AI
+//
+
+#pragma once
+
+// The subsystem an allocation is counted under: whatever tag the allocating
+// thread is in when it calls new
+enum AllocationTag
+{
+    ALLOC_UNTAGGED,
+    ALLOC_SIMULATION,
+    ALLOC_AI,
+    ALLOC_JOBS,
+    ALLOC_SNAPSHOTS,
+    ALLOC_INPUT,
+    ALLOC_RENDER,
+    ALLOC_TEXT,
+    ALLOC_ASSETS,
+    ALLOC_TOOLS,        // the overlay, the profiler and the like; never steady-state violations
+    ALLOCATION_TAG_COUNT
+};
+
+// What an allocation in the steady state does
+enum AllocationCheck
+{
+    ALLOCATION_CHECK_OFF,
+    ALLOCATION_CHECK_REPORT,    // count it, and print the first few
+    ALLOCATION_CHECK_ASSERT     // print it and assert, in builds that keep asserts
+};
+
+// Running totals of every global operator new and delete in the process, on
+// any thread, in all and per tag. Linking Allocations.cpp is what replaces the
+// global operators; they still allocate with malloc, they just count first.
+//
+// The game loop marks itself as in its steady state once it has warmed up;
+// from then on it should not allocate at all, and with checking on any
+// allocation outside ALLOC_TOOLS is a violation.
+class Allocations
+{
+public:
+    static constexpr int REPORTED_VIOLATIONS = 16;
+
+    static long long const get_count();
+    static long long const get_bytes();
+    static long long const get_free_count();
+
+    static long long const get_count(AllocationTag tag);
+    static long long const get_bytes(AllocationTag tag);
+    static const char *const get_tag_name(AllocationTag tag);
+
+    // The calling thread's tag; see AllocationScope
+    static AllocationTag const get_tag();
+    static void set_tag(AllocationTag tag);
+
+    // ————— STEADY STATE ————— //
+    static void set_check(AllocationCheck check);
+    static void set_steady_state(bool is_steady);
+    static bool const is_steady_state();
+    static long long const get_violation_count();
+};
+
+// Tags the calling thread's allocations for the rest of the block, then puts
+// back whatever tag it had. Inside ALLOC_TOOLS the tag stays ALLOC_TOOLS, so
+// that the text the overlay draws is still the overlay's.
+class AllocationScope
+{
+private:
+    AllocationTag m_previous_tag;
+
+public:
+    explicit AllocationScope(AllocationTag tag) : m_previous_tag(Allocations::get_tag())
+    {
+        if (m_previous_tag != ALLOC_TOOLS) Allocations::set_tag(tag);
+    }
+    ~AllocationScope() { Allocations::set_tag(m_previous_tag); }
+
+    AllocationScope(const AllocationScope &) = delete;
+    AllocationScope &operator=(const AllocationScope &) = delete;
+};
+
+#define ALLOCATION_JOIN_(a, b) a##b
+#define ALLOCATION_JOIN(a, b) ALLOCATION_JOIN_(a, b)
+#define ALLOCATION_TAG(tag) AllocationScope ALLOCATION_JOIN(allocation_scope_, __LINE__)(tag)
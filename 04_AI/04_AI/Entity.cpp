@@ -22,17 +22,19 @@
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
 #include "Entity.h"
+#include "Profiler.h"
+#include "GL.h"
 
-void Entity::ai_activate(Entity *player)
+void Entity::ai_activate(const Percept &percept)
 {
     switch (m_ai_type)
     {
         case BULLET:
-            ai_bullet();
+            ai_bullet(percept);
             break;
             
         case GUARD:
-            ai_guard(player);
+            ai_guard(percept);
             break;
             
         case FLYER:
@@ -43,33 +45,55 @@ void Entity::ai_activate(Entity *player)
     }
 }
 
-void Entity::ai_bullet()
+void Entity::ai_bullet(const Percept &percept)
 {
-    m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+    // shoot again once it is out of range or has hit a wall
+    bool is_spent = glm::distance(m_position, SHOOTER_MUZZLE) >= SHOOTER_RANGE ||
+                    m_map_collided_left || m_map_collided_right || m_map_collided_top || m_map_collided_bottom;
     
-    // shoot again once it hits the edge
-    if (m_position.x <= LEFT_EDGE - 4.0f) m_position = glm::vec3(15.0f, -4.0f, 0.0f);
+    if (is_spent) {
+        m_position = SHOOTER_MUZZLE;
+        
+        // aim at the player if the shooter can see them, otherwise fire blindly to the left
+        // (a bullet's eye is the muzzle, so the percept is from the shooter's point of view)
+        if (percept.sees_player && percept.distance > 0.0f)
+            m_aim = glm::vec3(percept.to_player / percept.distance, 0.0f);
+        else m_aim = glm::vec3(-1.0f, 0.0f, 0.0f);
+    }
+    
+    m_movement   = m_aim;
+    m_velocity.y = m_aim.y * m_speed;
+}
+
+void Entity::ai_stop()
+{
+    m_movement = glm::vec3(0.0f);
+}
+
+void Entity::ai_chase(const Percept &percept)
+{
+    if (fabs(percept.to_player.x) <= 0.05f) {
+        m_movement = glm::vec3(0.0f);
+    } else if (percept.to_player.x < 0.0f) {
+        m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+        face_left();
+    } else {
+        m_movement = glm::vec3(1.0f, 0.0f, 0.0f);
+        face_right();
+    }
 }
 
-void Entity::ai_guard(Entity *player)
+void Entity::ai_guard(const Percept &percept)
 {
     switch (m_ai_state) {
         case IDLE:
-            m_movement = glm::vec3(0.0f);
-            if (glm::distance(m_position, player->get_position()) < 4.0f) m_ai_state = WALKING;
+            ai_stop();
+            if (percept.distance < 4.0f) m_ai_state = WALKING;
             break;
             
         case WALKING:
-            if (m_position.x >= player->get_position().x - 0.05 && m_position.x <= player->get_position().x + 0.05) {
-                m_movement = glm::vec3(0.0f);
-            } else if (m_position.x > player->get_position().x) {
-                m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
-                face_left();
-            } else if (m_position.x < player->get_position().x) {
-                m_movement = glm::vec3(1.0f, 0.0f, 0.0f);
-                face_right();
-            }
-            if (glm::distance(m_position, player->get_position()) > 4.0f) m_ai_state = IDLE;
+            ai_chase(percept);
+            if (percept.distance > 4.0f) m_ai_state = IDLE;
             break;
             
         case ATTACKING:
@@ -81,25 +105,18 @@ void Entity::ai_guard(Entity *player)
 }
 
 void Entity::ai_fly() {
-    if (m_rotation_theta > 360) {
-        face_left();
-        m_speed *= -1;
-    }
-    if (m_rotation_theta < 180) {
-        face_right();
-        m_speed *= -1;
-    }
-    m_movement.x = m_speed;
-    m_velocity.x = m_speed;
-    m_rotation_theta += m_speed;
+    // The path turns around on its own; we only need to face the way it is heading
+    if (m_path.get_direction() < 0) face_left();
+    else face_right();
+    m_movement.x = m_path.get_direction();
 }
 
 // Default constructor
 Entity::Entity()
-    : m_position(0.0f), m_movement(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_model_matrix(1.0f),
-    m_speed(0.0f), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(0), m_velocity(0.0f), m_acceleration(0.0f), m_width(0.0f), m_height(0.0f)
+    : m_movement(0.0f), m_position(0.0f), m_scale(1.0f, 1.0f, 0.0f), m_velocity(0.0f), m_acceleration(0.0f),
+    m_model_matrix(1.0f), m_speed(0.0f), m_texture_id(0), m_animation_cols(0), m_animation_frames(0),
+    m_animation_index(0), m_animation_rows(0), m_animation_row(-1), m_animation_time(0.0f),
+    m_width(0.0f), m_height(0.0f)
 {
     // Initialize m_animation with zeros or any default value
     for (int i = 0; i < ANIMATION_ARRAY_LENGTH; ++i)
@@ -110,23 +127,27 @@ Entity::Entity()
 Entity::Entity(GLuint texture_id, float speed, glm::vec3 acceleration, float jump_power, int animation[4][4], float animation_time,
     int animation_frames, int animation_index, int animation_cols,
     int animation_rows, float width, float height, EntityType EntityType, AIType AIType, AIState AIState)
-    : m_position(0.0f), m_movement(0.0f), m_scale(width, height, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed),m_acceleration(acceleration), m_jumping_power(jump_power), m_animation_cols(animation_cols),
-    m_animation_frames(animation_frames), m_animation_index(animation_index),
-    m_animation_rows(animation_rows), m_animation_indices(nullptr),
-    m_animation_time(animation_time), m_texture_id(texture_id), m_velocity(0.0f),
-    m_width(width), m_height(height), m_entity_type(EntityType), m_ai_type(AIType), m_ai_state(AIState)
+    : m_entity_type(EntityType), m_ai_type(AIType), m_ai_state(AIState),
+    m_movement(0.0f), m_position(0.0f), m_scale(width, height, 0.0f), m_velocity(0.0f), m_acceleration(acceleration),
+    m_model_matrix(1.0f), m_speed(speed), m_jumping_power(jump_power), m_texture_id(texture_id),
+    m_animation_cols(animation_cols), m_animation_frames(animation_frames), m_animation_index(animation_index),
+    m_animation_rows(animation_rows), m_animation_row(-1), m_animation_time(animation_time),
+    m_width(width), m_height(height)
 {
     set_animation(animation);
     face_right();
+
+    if (m_ai_type == FLYER)
+        m_path = ParametricMotion::circle(glm::vec3(0.0f), FLYER_RADIUS, FLYER_ARC_START, FLYER_ARC_END, fabs(speed), true);
 }
 
 // Simpler constructor for partial initialization
 Entity::Entity(GLuint texture_id, float speed,  float width, float height, EntityType EntityType)
-    : m_position(0.0f), m_movement(0.0f), m_scale(width, height, 0.0f), m_model_matrix(1.0f),
-    m_speed(speed), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-    m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-    m_texture_id(texture_id), m_velocity(0.0f), m_acceleration(0.0f), m_width(width), m_height(height),m_entity_type(EntityType)
+    : m_entity_type(EntityType),
+    m_movement(0.0f), m_position(0.0f), m_scale(width, height, 0.0f), m_velocity(0.0f), m_acceleration(0.0f),
+    m_model_matrix(1.0f), m_speed(speed), m_texture_id(texture_id), m_animation_cols(0), m_animation_frames(0),
+    m_animation_index(0), m_animation_rows(0), m_animation_row(-1), m_animation_time(0.0f),
+    m_width(width), m_height(height)
 {
     // Initialize m_animation with zeros or any default value
     for (int i = 0; i < ANIMATION_ARRAY_LENGTH; ++i)
@@ -134,10 +155,11 @@ Entity::Entity(GLuint texture_id, float speed,  float width, float height, Entit
 }
 
 
-Entity::Entity(GLuint texture_id, float speed, float width, float height, EntityType EntityType, AIType AIType, AIState AIState): m_position(0.0f), m_movement(0.0f), m_scale(width, height, 0.0f), m_model_matrix(1.0f),
-m_speed(speed), m_animation_cols(0), m_animation_frames(0), m_animation_index(0),
-m_animation_rows(0), m_animation_indices(nullptr), m_animation_time(0.0f),
-m_texture_id(texture_id), m_velocity(0.0f), m_acceleration(0.0f), m_width(width), m_height(height),m_entity_type(EntityType), m_ai_type(AIType), m_ai_state(AIState)
+Entity::Entity(GLuint texture_id, float speed, float width, float height, EntityType EntityType, AIType AIType, AIState AIState): m_entity_type(EntityType), m_ai_type(AIType), m_ai_state(AIState),
+m_movement(0.0f), m_position(0.0f), m_scale(width, height, 0.0f), m_velocity(0.0f), m_acceleration(0.0f),
+m_model_matrix(1.0f), m_speed(speed), m_texture_id(texture_id), m_animation_cols(0), m_animation_frames(0),
+m_animation_index(0), m_animation_rows(0), m_animation_row(-1), m_animation_time(0.0f),
+m_width(width), m_height(height)
 {
 // Initialize m_animation with zeros or any default value
 for (int i = 0; i < ANIMATION_ARRAY_LENGTH; ++i)
@@ -170,18 +192,18 @@ void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint textu
     };
 
     // Step 4: And render
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    g_gl.bind_texture(GL_TEXTURE_2D, texture_id);
 
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
+    g_gl.vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    g_gl.enable_vertex_attrib_array(program->get_position_attribute());
 
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    g_gl.enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    g_gl.draw_arrays(GL_TRIANGLES, 0, 6);
 
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 }
 
 bool const Entity::check_collision(Entity* other) const
@@ -345,14 +367,10 @@ void const Entity::check_collision_x(Map *map)
         m_map_collided_right = true;
     }
 }
-void Entity::update(float delta_time, Entity *player, Entity *collidable_entities, int collidable_entity_count, Map *map, int current_enemy_count)
+void Entity::integrate(float delta_time)
 {
     if (!m_is_active) return;
     
-    // update enemy number with main
-    if (m_entity_type == PLAYER && current_enemy_count <= m_enemy_count)
-        m_enemy_count = current_enemy_count;
-
     m_collided_top    = false;
     m_collided_bottom = false;
     m_collided_left   = false;
@@ -363,9 +381,9 @@ void Entity::update(float delta_time, Entity *player, Entity *collidable_entitie
     m_map_collided_left   = false;
     m_map_collided_right  = false;
 
-    if (m_entity_type == ENEMY) ai_activate(player);
+    // Enemy AI is stepped in batches by AIStateMachine::update before this runs
     
-    if (m_animation_indices != NULL)
+    if (m_animation_row >= 0)
     {
         if (glm::length(m_movement) != 0)
         {
@@ -388,15 +406,63 @@ void Entity::update(float delta_time, Entity *player, Entity *collidable_entitie
     m_velocity.x = m_movement.x * m_speed;
     m_velocity += m_acceleration * delta_time;
     
-    if (m_ai_type == FLYER) m_position.y = m_rotation_center.y + glm::sin(m_rotation_theta * delta_time) * 1.6f;
+    if (m_ai_type == FLYER) m_path.advance(delta_time);
+}
+
+void Entity::move_y(float delta_time)
+{
+    if (m_ai_type == FLYER) m_position.y = m_path.get_position().y;
     else m_position.y += m_velocity.y * delta_time;
+}
+
+void Entity::move_x(float delta_time)
+{
+    if (m_ai_type == FLYER) m_position.x = m_path.get_position().x;
+    else m_position.x += m_velocity.x * delta_time;
+}
+
+void Entity::finish_step()
+{
+    if (m_is_jumping)
+    {
+        m_is_jumping = false;
+        m_velocity.y += m_jumping_power;
+    }
+    
+    m_model_matrix = glm::mat4(1.0f);
+    m_model_matrix = glm::translate(m_model_matrix, m_position);
+    m_model_matrix = glm::scale(m_model_matrix, m_scale);
+}
+
+void Entity::collide_with_map(float delta_time, Map *map)
+{
+    if (!m_is_active) return;
+    
+    move_y(delta_time);
+    check_collision_y(map);
+    
+    move_x(delta_time);
+    check_collision_x(map);
+    
+    finish_step();
+}
+
+void Entity::update(float delta_time, Entity *player, Entity *collidable_entities, int collidable_entity_count, Map *map, int current_enemy_count)
+{
+    PROFILE_ZONE("Entity::update");
+    if (!m_is_active) return;
+    
+    // update enemy number with main
+    if (m_entity_type == PLAYER && current_enemy_count <= m_enemy_count)
+        m_enemy_count = current_enemy_count;
+
+    integrate(delta_time);
+    
+    move_y(delta_time);
     check_collision_y(map);
     check_collision_y(collidable_entities, collidable_entity_count);
     
-    if (m_ai_type == FLYER) {
-        m_position.x = m_rotation_center.x + glm::cos(m_rotation_theta * delta_time) * 1.6f;
-    }
-    else m_position.x += m_velocity.x * delta_time;
+    move_x(delta_time);
     check_collision_x(map);
     check_collision_x(collidable_entities, collidable_entity_count);
     
@@ -408,42 +474,91 @@ void Entity::update(float delta_time, Entity *player, Entity *collidable_entitie
         }
     }
     
-    if (m_is_jumping)
-    {
-        m_is_jumping = false;
-        m_velocity.y += m_jumping_power;
-    }
-    
+    finish_step();
+}
+
+
+void Entity::save_state(StateWriter *writer) const
+{
+    writer->write(m_is_active);
+    writer->write(m_ai_state);
+    writer->write(m_position);
+    writer->write(m_movement);
+    writer->write(m_velocity);
+    writer->write(m_aim);
+    writer->write(m_is_jumping);
+    writer->write(m_animation_row);
+    writer->write(m_animation_index);
+    writer->write(m_animation_time);
+    writer->write(m_enemy_count);
+
+    writer->write(m_collided_top);
+    writer->write(m_collided_bottom);
+    writer->write(m_collided_left);
+    writer->write(m_collided_right);
+    writer->write(m_map_collided_top);
+    writer->write(m_map_collided_bottom);
+    writer->write(m_map_collided_left);
+    writer->write(m_map_collided_right);
+
+    if (m_ai_type == FLYER) m_path.save_state(writer);
+}
+
+void Entity::load_state(StateReader *reader)
+{
+    reader->read(&m_is_active);
+    reader->read(&m_ai_state);
+    reader->read(&m_position);
+    reader->read(&m_movement);
+    reader->read(&m_velocity);
+    reader->read(&m_aim);
+    reader->read(&m_is_jumping);
+    reader->read(&m_animation_row);
+    reader->read(&m_animation_index);
+    reader->read(&m_animation_time);
+    reader->read(&m_enemy_count);
+
+    reader->read(&m_collided_top);
+    reader->read(&m_collided_bottom);
+    reader->read(&m_collided_left);
+    reader->read(&m_collided_right);
+    reader->read(&m_map_collided_top);
+    reader->read(&m_map_collided_bottom);
+    reader->read(&m_map_collided_left);
+    reader->read(&m_map_collided_right);
+
+    if (m_ai_type == FLYER) m_path.load_state(reader);
+
+    // The model matrix follows from the position
     m_model_matrix = glm::mat4(1.0f);
     m_model_matrix = glm::translate(m_model_matrix, m_position);
     m_model_matrix = glm::scale(m_model_matrix, m_scale);
 }
 
-
 void Entity::render(ShaderProgram* program)
 {
     if (!m_is_active) return;
     
     program->set_model_matrix(m_model_matrix);
 
-    if (m_animation_indices != NULL)
+    if (m_animation_row >= 0)
     {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index]);
+        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation[m_animation_row][m_animation_index]);
         return;
     }
 
     float vertices[] = { -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5 };
     float tex_coords[] = { 0.0,  1.0, 1.0,  1.0, 1.0, 0.0,  0.0,  1.0, 1.0, 0.0,  0.0, 0.0 };
 
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    g_gl.bind_texture(GL_TEXTURE_2D, m_texture_id);
 
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    g_gl.enable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    g_gl.enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    g_gl.draw_arrays(GL_TRIANGLES, 0, 6);
 
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 }
@@ -4,6 +4,8 @@
 #include "Map.h"
 #include "glm/glm.hpp"
 #include "ShaderProgram.h"
+#include "ParametricMotion.h"
+#include "Perception.h"
 enum EntityType { PLATFORM, PLAYER, ENEMY  };
 enum AIType     { WALKER, GUARD, FLYER, SHOOTER, BULLET, NOTYPE };
 enum AIState    { WALKING, IDLE, ATTACKING, NOSTATE };
@@ -31,15 +33,19 @@ private:
     glm::vec3 m_scale;
 //    glm::vec3 m_rotation;
 //    glm::vec3 m_rotation_direction;
-    glm::vec3 m_rotation_center;
     glm::vec3 m_velocity;
     glm::vec3 m_acceleration;
 
     glm::mat4 m_model_matrix;
 
     float     m_speed,
-              m_jumping_power,
-    m_rotation_theta = 179.8f;
+              m_jumping_power;
+
+    // Bullets fly along this until they leave the shooter's range
+    glm::vec3 m_aim = glm::vec3(-1.0f, 0.0f, 0.0f);
+
+    // Flyers follow a closed-form path instead of integrating velocity
+    ParametricMotion m_path;
     
     bool m_is_jumping = false;
 
@@ -52,7 +58,9 @@ private:
         m_animation_index,
         m_animation_rows;
 
-    int* m_animation_indices = nullptr;
+    // Row of m_animation being played, or -1 for none. An index rather than a
+    // pointer, so that copying an entity (or restoring a snapshot) keeps it valid
+    int m_animation_row = -1;
     float m_animation_time = 0.0f;
 
     float m_width = 1.0f,
@@ -75,6 +83,11 @@ public:
     static constexpr int SECONDS_PER_FRAME = 6;
     static constexpr int ANIMATION_ARRAY_LENGTH = 4;
     static constexpr float ROT_INCREMENT = 1.0f;
+    static constexpr float FLYER_RADIUS    = 1.6f;
+    static constexpr float FLYER_ARC_START = 3.0f; // radians; the vulture swoops along the lower arc
+    static constexpr float FLYER_ARC_END   = 6.0f;
+    static constexpr glm::vec3 SHOOTER_MUZZLE = glm::vec3(15.0f, -4.0f, 0.0f);
+    static constexpr float SHOOTER_RANGE   = 14.0f;
     
 //    static bool shooter_is_active;
 //    GameResult game_result = NONE;
@@ -99,33 +112,50 @@ public:
     void const check_collision_x(Map *map);
     
     void update(float delta_time, Entity *player, Entity *collidable_entities, int collidable_entity_count, Map *map, int current_enemy_count);
+
+    // The same step as update() split into phases, so a batch of enemies can run
+    // each phase in parallel: integrate() (animation, velocity, paths), then
+    // collide_with_map() (move and resolve against the tiles on each axis)
+    void integrate(float delta_time);
+    void collide_with_map(float delta_time, Map *map);
+    void move_y(float delta_time);
+    void move_x(float delta_time);
+    void finish_step();
     void render(ShaderProgram* program);
 
-    void ai_activate(Entity *player);
-    void ai_bullet();
-    void ai_guard(Entity *player);
+    // Only what a step can change goes into a snapshot; type, size, speed,
+    // textures and animation tables are fixed when the level is built
+    void save_state(StateWriter *writer) const;
+    void load_state(StateReader *reader);
+
+    // AI reads what it knows about the player from this step's Perception pass
+    void ai_activate(const Percept &percept);
+    void ai_bullet(const Percept &percept);
+    void ai_guard(const Percept &percept);
+    void ai_stop();
+    void ai_chase(const Percept &percept);
     void ai_fly();
     
     void normalise_movement() { m_movement = glm::normalize(m_movement); }
 
     void face_left() {
-        if (m_entity_type == PLAYER) m_animation_indices = m_animation[LEFT];
-        if (m_entity_type == ENEMY) m_animation_indices = m_animation[MOVE_LEFT];
+        if (m_entity_type == PLAYER) m_animation_row = LEFT;
+        if (m_entity_type == ENEMY) m_animation_row = MOVE_LEFT;
     }
     void face_right() {
-        if (m_entity_type == PLAYER) m_animation_indices = m_animation[RIGHT];
-        if (m_entity_type == ENEMY) m_animation_indices = m_animation[MOVE_RIGHT];
+        if (m_entity_type == PLAYER) m_animation_row = RIGHT;
+        if (m_entity_type == ENEMY) m_animation_row = MOVE_RIGHT;
     }
-    void face_up() { m_animation_indices = m_animation[UP]; }
-    void face_down() { m_animation_indices = m_animation[DOWN]; }
+    void face_up() { m_animation_row = UP; }
+    void face_down() { m_animation_row = DOWN; }
 
     void move_left() { m_movement.x = -1.0f; face_left(); }
     void move_right() { m_movement.x = 1.0f;  face_right(); }
     void move_up() { m_movement.y = 1.0f;  face_up(); }
     void move_down() { m_movement.y = -1.0f; face_down(); }
     
-    void die_right() { if (m_entity_type == ENEMY) m_animation_indices = m_animation[DIE_RIGHT]; }
-    void die_left() { if (m_entity_type == ENEMY) m_animation_indices = m_animation[DIE_LEFT]; }
+    void die_right() { if (m_entity_type == ENEMY) m_animation_row = DIE_RIGHT; }
+    void die_left() { if (m_entity_type == ENEMY) m_animation_row = DIE_LEFT; }
     
     void const jump() { m_is_jumping = true; }
 
@@ -134,6 +164,7 @@ public:
     AIType     const get_ai_type()        const { return m_ai_type;       };
     AIState    const get_ai_state()       const { return m_ai_state;      };
     glm::vec3 const get_position()     const { return m_position; }
+    glm::vec3 const get_eye_position() const { return m_ai_type == BULLET ? SHOOTER_MUZZLE : m_position; }
     glm::vec3 const get_velocity()     const { return m_velocity; }
     glm::vec3 const get_acceleration() const { return m_acceleration; }
     glm::vec3 const get_movement()     const { return m_movement; }
@@ -150,6 +181,7 @@ public:
     bool      const get_map_collided_right() const { return m_map_collided_right; }
     bool      const get_map_collided_left() const { return m_map_collided_left; }
     bool      const get_activation_status() const { return m_is_active; }
+    ParametricMotion const &get_path() const { return m_path; }
     
     void activate()   { m_is_active = true;  };
     void deactivate() { m_is_active = false; };
@@ -158,9 +190,10 @@ public:
     void const set_ai_type(AIType new_ai_type){ m_ai_type = new_ai_type;};
     void const set_ai_state(AIState new_state){ m_ai_state = new_state;};
     void const set_position(glm::vec3 new_position) {
-        if (m_ai_type == FLYER) m_rotation_center = new_position;
+        if (m_ai_type == FLYER) m_path.set_center(new_position);
         else m_position = new_position;
     }
+    void const set_path(ParametricMotion new_path) { m_path = new_path; }
     void const set_velocity(glm::vec3 new_velocity) { m_velocity = new_velocity; }
     void const set_acceleration(glm::vec3 new_acceleration) { m_acceleration = new_acceleration; }
     void const set_movement(glm::vec3 new_movement) { m_movement = new_movement; }
@@ -0,0 +1,91 @@
+//
+//  FrameArena.cpp
+//  04_AI
+//
+
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+#include "Allocations.h"
+
+// Room for a frame to overflow a few times before the list of blocks itself
+// has to grow
+constexpr int RESERVED_BLOCKS = 8;
+
+FrameArena::FrameArena(size_t capacity)
+{
+    m_blocks.reserve(RESERVED_BLOCKS);
+    add_block(capacity);
+}
+
+FrameArena::~FrameArena() { free_blocks(); }
+
+FrameArena &FrameArena::frame()
+{
+    static FrameArena arena;
+    return arena;
+}
+
+void FrameArena::add_block(size_t capacity)
+{
+    ALLOCATION_TAG(ALLOC_RENDER);
+    m_blocks.push_back({ new unsigned char[capacity], capacity });
+    m_used = 0;
+}
+
+void FrameArena::free_blocks()
+{
+    for (Block &block : m_blocks) delete[] block.data;
+    m_blocks.clear();
+}
+
+size_t const FrameArena::get_capacity() const
+{
+    size_t capacity = 0;
+    for (const Block &block : m_blocks) capacity += block.capacity;
+    return capacity;
+}
+
+void *FrameArena::allocate(size_t size, size_t alignment)
+{
+    Block *block = &m_blocks.back();
+    uintptr_t base = (uintptr_t) block->data;
+    size_t offset = ((base + m_used + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+
+    if (offset + size > block->capacity)
+    {
+        add_block(std::max(block->capacity * 2, size + alignment));
+        block = &m_blocks.back();
+        base = (uintptr_t) block->data;
+        offset = ((base + alignment - 1) & ~(uintptr_t) (alignment - 1)) - base;
+    }
+
+    m_frame_bytes += offset + size - m_used;
+    m_used = offset + size;
+    m_high_water = std::max(m_high_water, m_frame_bytes);
+    return block->data + offset;
+}
+
+void FrameArena::deallocate(void *pointer, size_t size)
+{
+    // Only the newest allocation can be taken back
+    unsigned char *end = m_blocks.back().data + m_used;
+    if ((unsigned char *) pointer + size != end) return;
+
+    m_used -= size;
+    m_frame_bytes -= size;
+}
+
+void FrameArena::reset()
+{
+    // Outgrown: replace the chain with one block that fits it all
+    if (m_blocks.size() > 1)
+    {
+        size_t capacity = get_capacity();
+        free_blocks();
+        add_block(capacity);
+    }
+
+    m_used = 0;
+    m_frame_bytes = 0;
+}
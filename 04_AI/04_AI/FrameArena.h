@@ -0,0 +1,86 @@
+//
+//  FrameArena.h
+//  04_AI
+//
+
+#pragma once
+#include <cstddef>
+#include <vector>
+
+// A bump allocator for data that only has to last the frame, like the vertex
+// and texture coordinate arrays built to be drawn once. Allocating moves a
+// cursor and deallocating does nothing (bar handing back the newest
+// allocation, which lets a vector grow in place). Everything goes at once
+// when reset() is called, at the end of render().
+//
+// A frame that outgrows the arena chains another block from the heap. The
+// next reset() swaps them all for one block big enough for that frame, so
+// after the first few frames the arena stops going to the heap at all.
+//
+// Only the rendering thread uses the frame arena.
+class FrameArena
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+private:
+    struct Block
+    {
+        unsigned char *data;
+        size_t capacity;
+    };
+
+    std::vector<Block> m_blocks;    // allocations come from the last one
+    size_t m_used = 0;              // of the last block
+    size_t m_frame_bytes = 0;       // handed out since the last reset
+    size_t m_high_water = 0;        // the most m_frame_bytes has been
+
+    void add_block(size_t capacity);
+    void free_blocks();
+
+public:
+    explicit FrameArena(size_t capacity = DEFAULT_CAPACITY);
+    ~FrameArena();
+
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    void *allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+    void deallocate(void *pointer, size_t size);
+    void reset();
+
+    size_t const get_used()        const { return m_frame_bytes; }
+    size_t const get_high_water()  const { return m_high_water;  }
+    int    const get_block_count() const { return (int) m_blocks.size(); }
+    size_t const get_capacity()    const;
+
+    // The one the renderer allocates its per-frame data from
+    static FrameArena &frame();
+};
+
+// Lets standard containers allocate from a FrameArena; by default the frame
+// arena. Such a container must not outlive the arena's next reset().
+template <typename T>
+class ArenaAllocator
+{
+private:
+    FrameArena *m_arena;
+
+    template <typename U> friend class ArenaAllocator;
+
+public:
+    typedef T value_type;
+
+    ArenaAllocator() : m_arena(&FrameArena::frame()) { }
+    explicit ArenaAllocator(FrameArena *arena) : m_arena(arena) { }
+    template <typename U> ArenaAllocator(const ArenaAllocator<U> &other) : m_arena(other.m_arena) { }
+
+    T *allocate(size_t count) { return (T *) m_arena->allocate(count * sizeof(T), alignof(T)); }
+    void deallocate(T *pointer, size_t count) { m_arena->deallocate(pointer, count * sizeof(T)); }
+
+    template <typename U> bool operator==(const ArenaAllocator<U> &other) const { return m_arena == other.m_arena; }
+    template <typename U> bool operator!=(const ArenaAllocator<U> &other) const { return m_arena != other.m_arena; }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, ArenaAllocator<T>>;
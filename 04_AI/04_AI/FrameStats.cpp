@@ -0,0 +1,64 @@
+//
+//  FrameStats.cpp
+//  04_AI
+//
+
+#include "FrameStats.h"
+#include <chrono>
+
+FrameCounters FrameStats::s_current;
+int64_t FrameStats::s_frame_start_ns = -1;
+long long FrameStats::s_allocations_at_start = 0, FrameStats::s_bytes_at_start = 0;
+long long FrameStats::s_tag_allocations_at_start[ALLOCATION_TAG_COUNT], FrameStats::s_tag_bytes_at_start[ALLOCATION_TAG_COUNT];
+
+static int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+FrameCounters const FrameStats::get_current()
+{
+    FrameCounters counters = s_current;
+    counters.frame_ns = s_frame_start_ns < 0 ? 0 : now_ns() - s_frame_start_ns;
+    counters.allocations = Allocations::get_count() - s_allocations_at_start;
+    counters.allocated_bytes = Allocations::get_bytes() - s_bytes_at_start;
+    for (int tag = 0; tag < ALLOCATION_TAG_COUNT; tag++)
+    {
+        counters.tag_allocations[tag] = Allocations::get_count((AllocationTag) tag) - s_tag_allocations_at_start[tag];
+        counters.tag_bytes[tag] = Allocations::get_bytes((AllocationTag) tag) - s_tag_bytes_at_start[tag];
+    }
+    return counters;
+}
+
+void FrameStats::discard_since(const FrameCounters &before)
+{
+    FrameCounters now = get_current();
+    s_allocations_at_start += now.allocations - before.allocations;
+    s_bytes_at_start += now.allocated_bytes - before.allocated_bytes;
+    for (int tag = 0; tag < ALLOCATION_TAG_COUNT; tag++)
+    {
+        s_tag_allocations_at_start[tag] += now.tag_allocations[tag] - before.tag_allocations[tag];
+        s_tag_bytes_at_start[tag] += now.tag_bytes[tag] - before.tag_bytes[tag];
+    }
+
+    s_current.fixed_steps = before.fixed_steps;
+    s_current.draw_calls = before.draw_calls;
+    s_current.texture_binds = before.texture_binds;
+    s_current.uniform_uploads = before.uniform_uploads;
+}
+
+FrameCounters const FrameStats::end_frame()
+{
+    FrameCounters finished = get_current();
+
+    s_current = FrameCounters();
+    s_frame_start_ns = now_ns();
+    s_allocations_at_start = Allocations::get_count();
+    s_bytes_at_start = Allocations::get_bytes();
+    for (int tag = 0; tag < ALLOCATION_TAG_COUNT; tag++)
+    {
+        s_tag_allocations_at_start[tag] = Allocations::get_count((AllocationTag) tag);
+        s_tag_bytes_at_start[tag] = Allocations::get_bytes((AllocationTag) tag);
+    }
+    return finished;
+}
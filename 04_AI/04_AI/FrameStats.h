@@ -0,0 +1,50 @@
+//
+//  FrameStats.h
+//  04_AI
+//
+
+#pragma once
+#include <cstdint>
+#include "Allocations.h"
+
+// What one frame cost and did
+struct FrameCounters
+{
+    int64_t frame_ns = 0;
+    int fixed_steps = 0;
+    int draw_calls = 0;
+    int texture_binds = 0;
+    int uniform_uploads = 0;
+    long long allocations = 0;
+    long long allocated_bytes = 0;
+    long long tag_allocations[ALLOCATION_TAG_COUNT] = {};
+    long long tag_bytes[ALLOCATION_TAG_COUNT] = {};
+};
+
+// Per-frame counters bumped by the renderer and the fixed-step loop. The
+// render counters are only touched from the main thread, so they are plain
+// ints; allocations come from the process-wide totals in Allocations.
+class FrameStats
+{
+private:
+    static FrameCounters s_current;
+    static int64_t s_frame_start_ns;
+    static long long s_allocations_at_start, s_bytes_at_start;
+    static long long s_tag_allocations_at_start[ALLOCATION_TAG_COUNT], s_tag_bytes_at_start[ALLOCATION_TAG_COUNT];
+
+public:
+    static void count_fixed_step() { s_current.fixed_steps++; }
+    static void count_draw_call() { s_current.draw_calls++; }
+    static void count_texture_bind() { s_current.texture_binds++; }
+    static void count_uniform_upload() { s_current.uniform_uploads++; }
+
+    // The frame so far
+    static FrameCounters const get_current();
+
+    // Forget everything counted since `before` was taken from get_current(),
+    // so that drawing the counters doesn't show up in them
+    static void discard_since(const FrameCounters &before);
+
+    // Closes the frame: returns its counters and starts the next one
+    static FrameCounters const end_frame();
+};
@@ -0,0 +1,87 @@
+//
+//  GL.cpp
+//  04_AI
+//
+
+#include "GL.h"
+#include "FrameStats.h"
+
+const GLFunctions GL_DRIVER =
+{
+    // ————— SHADERS ————— //
+    [](GLenum type) { return glCreateShader(type); },
+    [](GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths) { glShaderSource(shader, count, strings, lengths); },
+    [](GLuint shader) { glCompileShader(shader); },
+    [](GLuint shader, GLenum name, GLint *value) { glGetShaderiv(shader, name, value); },
+    [](GLuint shader, GLsizei size, GLsizei *length, GLchar *log) { glGetShaderInfoLog(shader, size, length, log); },
+    [](GLuint shader) { glDeleteShader(shader); },
+
+    []() { return glCreateProgram(); },
+    [](GLuint program, GLuint shader) { glAttachShader(program, shader); },
+    [](GLuint program) { glLinkProgram(program); },
+    [](GLuint program, GLenum name, GLint *value) { glGetProgramiv(program, name, value); },
+    [](GLuint program) { glDeleteProgram(program); },
+    [](GLuint program) { glUseProgram(program); },
+
+    [](GLuint program, const GLchar *name) { return glGetUniformLocation(program, name); },
+    [](GLuint program, const GLchar *name) { return glGetAttribLocation(program, name); },
+    [](GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w) { glUniform4f(location, x, y, z, w); },
+    [](GLint location, GLsizei count, GLboolean transpose, const GLfloat *value) { glUniformMatrix4fv(location, count, transpose, value); },
+
+    // ————— TEXTURES ————— //
+    [](GLsizei count, GLuint *textures) { glGenTextures(count, textures); },
+    [](GLsizei count, const GLuint *textures) { glDeleteTextures(count, textures); },
+    [](GLenum target, GLuint texture) { glBindTexture(target, texture); },
+    [](GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+       GLint border, GLenum format, GLenum type, const void *pixels)
+    {
+        glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+    },
+    [](GLenum target, GLenum name, GLint value) { glTexParameteri(target, name, value); },
+
+    // ————— DRAWING ————— //
+    [](GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, const void *pointer)
+    {
+        glVertexAttribPointer(index, size, type, normalised, stride, pointer);
+    },
+    [](GLuint index) { glEnableVertexAttribArray(index); },
+    [](GLuint index) { glDisableVertexAttribArray(index); },
+    [](GLenum mode, GLint first, GLsizei count) { glDrawArrays(mode, first, count); },
+};
+
+static GLFunctions s_backend = GL_DRIVER;
+
+// The backend's own table, with the counted calls passing through FrameStats
+static GLFunctions const with_counters(const GLFunctions &backend)
+{
+    GLFunctions table = backend;
+    table.uniform_4f = [](GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+    {
+        FrameStats::count_uniform_upload();
+        s_backend.uniform_4f(location, x, y, z, w);
+    };
+    table.uniform_matrix_4fv = [](GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        FrameStats::count_uniform_upload();
+        s_backend.uniform_matrix_4fv(location, count, transpose, value);
+    };
+    table.bind_texture = [](GLenum target, GLuint texture)
+    {
+        FrameStats::count_texture_bind();
+        s_backend.bind_texture(target, texture);
+    };
+    table.draw_arrays = [](GLenum mode, GLint first, GLsizei count)
+    {
+        FrameStats::count_draw_call();
+        s_backend.draw_arrays(mode, first, count);
+    };
+    return table;
+}
+
+GLFunctions g_gl = with_counters(GL_DRIVER);
+
+void set_gl_backend(const GLFunctions &backend)
+{
+    s_backend = backend;
+    g_gl = with_counters(backend);
+}
@@ -0,0 +1,65 @@
+//
+//  GL.h
+//  04_AI
+//
+
+#pragma once
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL_opengl.h>
+
+// Every GL call the engine makes goes through this table rather than straight
+// to the driver, so the renderer can run against GLRecorder with no context
+// at all. The calls keep GL's names and arguments, minus the gl prefix.
+struct GLFunctions
+{
+    // ————— SHADERS ————— //
+    GLuint (*create_shader)(GLenum type);
+    void   (*shader_source)(GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths);
+    void   (*compile_shader)(GLuint shader);
+    void   (*get_shaderiv)(GLuint shader, GLenum name, GLint *value);
+    void   (*get_shader_info_log)(GLuint shader, GLsizei size, GLsizei *length, GLchar *log);
+    void   (*delete_shader)(GLuint shader);
+
+    GLuint (*create_program)();
+    void   (*attach_shader)(GLuint program, GLuint shader);
+    void   (*link_program)(GLuint program);
+    void   (*get_programiv)(GLuint program, GLenum name, GLint *value);
+    void   (*delete_program)(GLuint program);
+    void   (*use_program)(GLuint program);
+
+    GLint  (*get_uniform_location)(GLuint program, const GLchar *name);
+    GLint  (*get_attrib_location)(GLuint program, const GLchar *name);
+    void   (*uniform_4f)(GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w);
+    void   (*uniform_matrix_4fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value);
+
+    // ————— TEXTURES ————— //
+    void   (*gen_textures)(GLsizei count, GLuint *textures);
+    void   (*delete_textures)(GLsizei count, const GLuint *textures);
+    void   (*bind_texture)(GLenum target, GLuint texture);
+    void   (*tex_image_2d)(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+                           GLint border, GLenum format, GLenum type, const void *pixels);
+    void   (*tex_parameteri)(GLenum target, GLenum name, GLint value);
+
+    // ————— DRAWING ————— //
+    void   (*vertex_attrib_pointer)(GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, const void *pointer);
+    void   (*enable_vertex_attrib_array)(GLuint index);
+    void   (*disable_vertex_attrib_array)(GLuint index);
+    void   (*draw_arrays)(GLenum mode, GLint first, GLsizei count);
+};
+
+// The driver's own functions. Each entry calls its gl function rather than
+// pointing at it, as GLEW only loads those once there is a context.
+extern const GLFunctions GL_DRIVER;
+
+// What the engine calls: the backend last given to set_gl_backend() (GL_DRIVER
+// to begin with), behind the one place that counts draw calls, texture binds
+// and uniform uploads for FrameStats
+extern GLFunctions g_gl;
+
+void set_gl_backend(const GLFunctions &backend);
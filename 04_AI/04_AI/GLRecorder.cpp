@@ -0,0 +1,274 @@
+//
+//  GLRecorder.cpp
+//  04_AI
+//
+
+#include "GLRecorder.h"
+#include <cstdarg>
+#include <cstdio>
+#include <set>
+#include "GL.h"
+
+constexpr int MAX_ATTRIBUTES = 16;
+
+// ————— STATE ————— //
+struct Attribute
+{
+    bool is_enabled = false;
+    const void *pointer = nullptr;
+    GLint size = 0;
+    GLenum type = GL_FLOAT;
+    GLsizei stride = 0;
+};
+
+// The slice of GL's state that the engine's calls depend on
+struct RecordedGL
+{
+    GLCounts counts;
+    std::vector<std::string> errors;
+
+    GLuint next_id = 1;
+    std::set<GLuint> shaders, programs, textures;
+    std::vector<std::string> uniform_names, attribute_names;
+
+    GLuint current_program = 0;
+    GLuint bound_texture = 0;
+    Attribute attributes[MAX_ATTRIBUTES];
+};
+
+static RecordedGL s_gl;
+static bool s_is_installed = false;
+
+static void error(const char *format, ...)
+{
+    s_gl.counts.errors++;
+    if (s_gl.errors.size() >= GLRecorder::MAX_ERROR_MESSAGES) return;
+
+    char message[256];
+    va_list arguments;
+    va_start(arguments, format);
+    vsnprintf(message, sizeof(message), format, arguments);
+    va_end(arguments);
+    s_gl.errors.push_back(message);
+}
+
+// Where a name was first asked for stands in for its location; -1 once
+// there are more names than a location can take
+static GLint location_of(std::vector<std::string> *names, const char *name, int limit)
+{
+    for (int i = 0; i < (int) names->size(); i++)
+        if ((*names)[i] == name) return i;
+    if ((int) names->size() >= limit) return -1;
+    names->push_back(name);
+    return (GLint) names->size() - 1;
+}
+
+static int bytes_per_component(GLenum type)
+{
+    switch (type)
+    {
+        case GL_BYTE: case GL_UNSIGNED_BYTE:   return 1;
+        case GL_SHORT: case GL_UNSIGNED_SHORT: return 2;
+        default:                               return 4;
+    }
+}
+
+static int components_of(GLenum format)
+{
+    switch (format)
+    {
+        case GL_RGBA: case GL_BGRA: return 4;
+        case GL_RGB: case GL_BGR:   return 3;
+        case GL_RG:                 return 2;
+        default:                    return 1;
+    }
+}
+
+static void count_uniform(GLint location, long long bytes)
+{
+    s_gl.counts.uniform_uploads++;
+    s_gl.counts.bytes_uploaded += bytes;
+    if (s_gl.current_program == 0) error("uniform %d uploaded with no program in use", location);
+}
+
+static bool check_attribute(GLuint index, const char *call)
+{
+    if (index < MAX_ATTRIBUTES) return true;
+    error("%s: attribute %d does not exist (a location of -1?)", call, (int) index);
+    return false;
+}
+
+// ————— TABLE ————— //
+static const GLFunctions RECORDER =
+{
+    // ————— SHADERS ————— //
+    [](GLenum type)
+    {
+        s_gl.shaders.insert(s_gl.next_id);
+        return s_gl.next_id++;
+    },
+    [](GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths)
+    {
+        if (!s_gl.shaders.count(shader)) error("shader_source: no shader %u", shader);
+    },
+    [](GLuint shader)
+    {
+        if (!s_gl.shaders.count(shader)) error("compile_shader: no shader %u", shader);
+    },
+    [](GLuint shader, GLenum name, GLint *value)
+    {
+        *value = name == GL_COMPILE_STATUS ? GL_TRUE : 0;
+    },
+    [](GLuint shader, GLsizei size, GLsizei *length, GLchar *log)
+    {
+        if (length) *length = 0;
+        if (size > 0) log[0] = '\0';
+    },
+    [](GLuint shader) { s_gl.shaders.erase(shader); },
+
+    []()
+    {
+        s_gl.programs.insert(s_gl.next_id);
+        return s_gl.next_id++;
+    },
+    [](GLuint program, GLuint shader)
+    {
+        if (!s_gl.programs.count(program) || !s_gl.shaders.count(shader))
+            error("attach_shader: no program %u or shader %u", program, shader);
+    },
+    [](GLuint program)
+    {
+        if (!s_gl.programs.count(program)) error("link_program: no program %u", program);
+    },
+    [](GLuint program, GLenum name, GLint *value)
+    {
+        *value = name == GL_LINK_STATUS ? GL_TRUE : 0;
+    },
+    [](GLuint program)
+    {
+        s_gl.programs.erase(program);
+        if (s_gl.current_program == program) s_gl.current_program = 0;
+    },
+    [](GLuint program)
+    {
+        s_gl.counts.program_binds++;
+        if (program == s_gl.current_program) s_gl.counts.redundant_binds++;
+        if (program != 0 && !s_gl.programs.count(program)) error("use_program: no program %u", program);
+        s_gl.current_program = program;
+    },
+
+    [](GLuint program, const GLchar *name) { return location_of(&s_gl.uniform_names, name, 1 << 16); },
+    [](GLuint program, const GLchar *name) { return location_of(&s_gl.attribute_names, name, MAX_ATTRIBUTES); },
+    [](GLint location, GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+    {
+        count_uniform(location, 4 * sizeof(GLfloat));
+    },
+    [](GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+    {
+        count_uniform(location, (long long) count * 16 * sizeof(GLfloat));
+    },
+
+    // ————— TEXTURES ————— //
+    [](GLsizei count, GLuint *textures)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            textures[i] = s_gl.next_id++;
+            s_gl.textures.insert(textures[i]);
+        }
+    },
+    [](GLsizei count, const GLuint *textures)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            if (textures[i] != 0 && !s_gl.textures.erase(textures[i])) error("delete_textures: no texture %u", textures[i]);
+            if (s_gl.bound_texture == textures[i]) s_gl.bound_texture = 0;
+        }
+    },
+    [](GLenum target, GLuint texture)
+    {
+        s_gl.counts.texture_binds++;
+        if (texture == s_gl.bound_texture) s_gl.counts.redundant_binds++;
+        if (texture != 0 && !s_gl.textures.count(texture)) error("bind_texture: texture %u was never generated", texture);
+        s_gl.bound_texture = texture;
+    },
+    [](GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+       GLint border, GLenum format, GLenum type, const void *pixels)
+    {
+        if (s_gl.bound_texture == 0) error("tex_image_2d with no texture bound");
+        if (pixels) s_gl.counts.bytes_uploaded += (long long) width * height * components_of(format) * bytes_per_component(type);
+    },
+    [](GLenum target, GLenum name, GLint value)
+    {
+        if (s_gl.bound_texture == 0) error("tex_parameteri with no texture bound");
+    },
+
+    // ————— DRAWING ————— //
+    [](GLuint index, GLint size, GLenum type, GLboolean normalised, GLsizei stride, const void *pointer)
+    {
+        if (!check_attribute(index, "vertex_attrib_pointer")) return;
+        Attribute &attribute = s_gl.attributes[index];
+        attribute.pointer = pointer;
+        attribute.size = size;
+        attribute.type = type;
+        attribute.stride = stride;
+    },
+    [](GLuint index)
+    {
+        if (check_attribute(index, "enable_vertex_attrib_array")) s_gl.attributes[index].is_enabled = true;
+    },
+    [](GLuint index)
+    {
+        if (check_attribute(index, "disable_vertex_attrib_array")) s_gl.attributes[index].is_enabled = false;
+    },
+    [](GLenum mode, GLint first, GLsizei count)
+    {
+        s_gl.counts.draw_calls++;
+        s_gl.counts.vertices += count;
+
+        if (s_gl.current_program == 0) error("draw_arrays with no program in use");
+        if (s_gl.bound_texture == 0)   error("draw_arrays with no texture bound");
+        if (count < 0)                 error("draw_arrays with %d vertices", count);
+
+        // The arrays live in client memory, so every draw sends them again
+        bool has_attributes = false;
+        for (int i = 0; i < MAX_ATTRIBUTES; i++)
+        {
+            const Attribute &attribute = s_gl.attributes[i];
+            if (!attribute.is_enabled) continue;
+            has_attributes = true;
+
+            if (!attribute.pointer) error("draw_arrays: attribute %d is enabled with no array", i);
+            int element_size = attribute.size * bytes_per_component(attribute.type);
+            s_gl.counts.bytes_uploaded += (long long) count * (attribute.stride ? attribute.stride : element_size);
+        }
+        if (!has_attributes) error("draw_arrays with no attributes enabled");
+    },
+};
+
+// ————— RECORDER ————— //
+void GLRecorder::install()
+{
+    s_gl = RecordedGL();
+    set_gl_backend(RECORDER);
+    s_is_installed = true;
+}
+
+void GLRecorder::uninstall()
+{
+    set_gl_backend(GL_DRIVER);
+    s_is_installed = false;
+}
+
+bool const GLRecorder::is_installed() { return s_is_installed; }
+
+GLCounts const GLRecorder::get_current() { return s_gl.counts; }
+
+GLCounts const GLRecorder::end_frame()
+{
+    GLCounts finished = s_gl.counts;
+    s_gl.counts = GLCounts();
+    return finished;
+}
+
+const std::vector<std::string> &GLRecorder::get_errors() { return s_gl.errors; }
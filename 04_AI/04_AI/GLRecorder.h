@@ -0,0 +1,49 @@
+//
+//  GLRecorder.h
+//  04_AI
+//
+
+#pragma once
+#include <string>
+#include <vector>
+
+// What the renderer asked GL to do over one frame
+struct GLCounts
+{
+    int draw_calls = 0;
+    long long vertices = 0;
+    int texture_binds = 0;
+    int program_binds = 0;
+    int redundant_binds = 0;        // of the texture or program already bound
+    int uniform_uploads = 0;
+    long long bytes_uploaded = 0;   // texture images, uniforms and the client-side vertex arrays each draw reads
+    int errors = 0;
+};
+
+// A GL backend that draws nothing. install() puts it behind g_gl; from then on
+// every call is counted and checked against the state the calls so far have
+// set up (a draw with no program or texture bound, an attribute enabled with
+// no array behind it, a texture that was never generated), and whatever it
+// would have returned (ids, locations, link status) is made up. Errors are
+// kept as messages as well as counted.
+//
+// Not thread safe: like the driver, it expects one rendering thread.
+class GLRecorder
+{
+public:
+    static constexpr int MAX_ERROR_MESSAGES = 64;
+
+    // Starts from a fresh, empty GL each time
+    static void install();
+    static void uninstall();
+    static bool const is_installed();
+
+    // The frame so far
+    static GLCounts const get_current();
+
+    // Closes the frame: returns its counts and starts the next one. The GL
+    // state (what is bound, what exists) carries over.
+    static GLCounts const end_frame();
+
+    static const std::vector<std::string> &get_errors();
+};
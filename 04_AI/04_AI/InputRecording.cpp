@@ -0,0 +1,139 @@
+//
+//  InputRecording.cpp
+//  04_AI
+//
+
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "InputRecording.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static const char MAGIC[4] = { 'A', 'I', 'R', 'C' };
+
+static void write_u32(std::vector<unsigned char> *out, unsigned int value)
+{
+    for (int i = 0; i < 4; i++) out->push_back((unsigned char) (value >> (8 * i)));
+}
+
+static void write_varint(std::vector<unsigned char> *out, unsigned int value)
+{
+    while (value >= 0x80)
+    {
+        out->push_back((unsigned char) (value | 0x80));
+        value >>= 7;
+    }
+    out->push_back((unsigned char) value);
+}
+
+static bool read_u32(const std::vector<unsigned char> &in, size_t *cursor, unsigned int *value)
+{
+    if (*cursor + 4 > in.size()) return false;
+    *value = 0;
+    for (int i = 0; i < 4; i++) *value |= (unsigned int) in[(*cursor)++] << (8 * i);
+    return true;
+}
+
+static bool read_varint(const std::vector<unsigned char> &in, size_t *cursor, unsigned int *value)
+{
+    *value = 0;
+    for (int shift = 0; shift < 32; shift += 7)
+    {
+        if (*cursor >= in.size()) return false;
+        unsigned char byte = in[(*cursor)++];
+        *value |= (unsigned int) (byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+bool InputRecording::save(const char *filepath) const
+{
+    // Encode the runs first so the header can carry their count
+    std::vector<unsigned char> runs;
+    unsigned int run_count = 0;
+    for (size_t i = 0; i < m_inputs.size(); )
+    {
+        size_t run_end = i + 1;
+        while (run_end < m_inputs.size() && m_inputs[run_end] == m_inputs[i]) run_end++;
+
+        runs.push_back(m_inputs[i]);
+        write_varint(&runs, (unsigned int) (run_end - i));
+        run_count++;
+        i = run_end;
+    }
+
+    std::vector<unsigned char> bytes(MAGIC, MAGIC + 4);
+    write_u32(&bytes, VERSION);
+    write_u32(&bytes, (unsigned int) m_inputs.size());
+    write_u32(&bytes, m_final_checksum);
+    write_u32(&bytes, run_count);
+    bytes.insert(bytes.end(), runs.begin(), runs.end());
+
+    std::ofstream outfile(filepath, std::ios::binary);
+    if (!outfile)
+    {
+        LOG("Unable to write input recording " << filepath << ".");
+        return false;
+    }
+    outfile.write((const char *) bytes.data(), bytes.size());
+    return (bool) outfile;
+}
+
+bool InputRecording::load(const char *filepath)
+{
+    std::ifstream infile(filepath, std::ios::binary);
+    if (!infile)
+    {
+        LOG("Unable to open input recording " << filepath << ".");
+        return false;
+    }
+    std::vector<unsigned char> bytes((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+
+    size_t cursor = 4;
+    unsigned int version, step_count, checksum, run_count;
+    if (bytes.size() < 4 || !std::equal(MAGIC, MAGIC + 4, bytes.begin()) ||
+        !read_u32(bytes, &cursor, &version) || version != VERSION ||
+        !read_u32(bytes, &cursor, &step_count) ||
+        !read_u32(bytes, &cursor, &checksum) ||
+        !read_u32(bytes, &cursor, &run_count))
+    {
+        LOG("Input recording " << filepath << " has a bad header.");
+        return false;
+    }
+
+    // Add up the runs before reserving anything, so that only a count the
+    // file actually holds is ever allocated, whatever its header says
+    size_t runs_start = cursor, total = 0;
+    for (unsigned int run = 0; run < run_count; run++)
+    {
+        unsigned int length;
+        if (cursor >= bytes.size()) break;
+        cursor++;
+        if (!read_varint(bytes, &cursor, &length) || total + length > step_count) break;
+        total += length;
+    }
+
+    if (total != step_count)
+    {
+        LOG("Input recording " << filepath << " is truncated.");
+        return false;
+    }
+
+    std::vector<unsigned char> inputs;
+    inputs.reserve(total);
+    cursor = runs_start;
+    while (inputs.size() < total)
+    {
+        unsigned int length;
+        unsigned char input = bytes[cursor++];
+        read_varint(bytes, &cursor, &length);
+        inputs.insert(inputs.end(), length, input);
+    }
+
+    m_inputs.swap(inputs);
+    m_final_checksum = checksum;
+    return true;
+}
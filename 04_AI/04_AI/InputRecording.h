@@ -0,0 +1,48 @@
+//
+//  InputRecording.h
+//  04_AI
+//
+
+#pragma once
+#include <vector>
+#include "Allocations.h"
+
+// The player's input for every fixed step of a session, one InputBits mask per
+// step, plus the Simulation checksum the session ended on.
+//
+// On disk the masks are run-length encoded, since a held key gives long runs of
+// the same byte:
+//   "AIRC", u32 version, u32 step count, u32 final checksum, u32 run count,
+//   then per run: u8 mask, varint run length
+// All integers are little-endian.
+class InputRecording
+{
+private:
+    std::vector<unsigned char> m_inputs;
+    unsigned int m_final_checksum = 0;
+
+public:
+    static constexpr unsigned int VERSION = 1;
+
+    // ————— METHODS ————— //
+    void clear() { m_inputs.clear(); m_final_checksum = 0; }
+    void record(unsigned char input)
+    {
+        ALLOCATION_TAG(ALLOC_INPUT);
+        m_inputs.push_back(input);
+    }
+
+    // Drops every step from step_count on, to branch off from a rewind
+    void truncate(int step_count) { if (step_count < (int) m_inputs.size()) m_inputs.resize(step_count); }
+
+    bool save(const char *filepath) const;
+    bool load(const char *filepath);
+
+    // ————— GETTERS ————— //
+    unsigned char const get_input(int step)  const { return m_inputs[step]; }
+    int           const get_step_count()     const { return (int) m_inputs.size(); }
+    unsigned int  const get_final_checksum() const { return m_final_checksum; }
+
+    // ————— SETTERS ————— //
+    void const set_final_checksum(unsigned int new_checksum) { m_final_checksum = new_checksum; }
+};
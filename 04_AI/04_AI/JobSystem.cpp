@@ -0,0 +1,165 @@
+//
+//  JobSystem.cpp
+//  04_AI
+//
+
+#include "JobSystem.h"
+#include <algorithm>
+#include <string>
+#include "Profiler.h"
+
+bool JobSystem::WorkQueue::push(const Job &job)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == (int) jobs.size()) return false;
+    jobs[(head + count) % jobs.size()] = job;
+    count++;
+    return true;
+}
+
+bool JobSystem::WorkQueue::pop_back(Job *job)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) return false;
+    count--;
+    *job = jobs[(head + count) % jobs.size()];
+    return true;
+}
+
+bool JobSystem::WorkQueue::steal_front(Job *job)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (count == 0) return false;
+    *job = jobs[head];
+    head = (head + 1) % jobs.size();
+    count--;
+    return true;
+}
+
+JobSystem::JobSystem(int worker_count)
+{
+    if (worker_count < 0)
+    {
+        int hardware_threads = (int) std::thread::hardware_concurrency();
+        worker_count = std::max(hardware_threads - 1, 0);
+    }
+
+    for (int i = 0; i < worker_count + 1; i++)
+    {
+        WorkQueue *queue = new WorkQueue();
+        queue->jobs.resize(QUEUE_CAPACITY);
+        m_queues.push_back(queue);
+    }
+
+    for (int i = 0; i < worker_count; i++)
+        m_workers.emplace_back(&JobSystem::worker_loop, this, i);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+        m_is_running = false;
+    }
+    m_wake.notify_all();
+
+    for (std::thread &worker : m_workers) worker.join();
+    for (WorkQueue *queue : m_queues) delete queue;
+}
+
+bool const JobSystem::try_run_one(int queue_index)
+{
+    Job job;
+    bool found = m_queues[queue_index]->pop_back(&job);
+
+    // Our own queue is empty, so go and take the oldest work from someone else
+    for (int i = 1; !found && i < (int) m_queues.size(); i++)
+        found = m_queues[(queue_index + i) % m_queues.size()]->steal_front(&job);
+
+    if (!found) return false;
+
+    {
+        PROFILE_ZONE("job");
+        ALLOCATION_TAG(job.tag);
+        (*job.function)(job.begin, job.end);
+    }
+    m_pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+    job.remaining->fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::worker_loop(int queue_index)
+{
+    ALLOCATION_TAG(ALLOC_JOBS);
+    if (Profiler::is_enabled()) Profiler::set_thread_name(("worker " + std::to_string(queue_index)).c_str());
+
+    int idle_spins = 0;
+
+    while (m_is_running)
+    {
+        if (try_run_one(queue_index))
+        {
+            idle_spins = 0;
+            continue;
+        }
+
+        if (++idle_spins < SPINS_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_sleep_mutex);
+        m_wake.wait(lock, [this] { return m_pending_jobs.load() > 0 || !m_is_running; });
+        idle_spins = 0;
+    }
+}
+
+void JobSystem::parallel_for(int count, int grain, const RangeFunction &function)
+{
+    if (count <= 0) return;
+
+    grain = std::max(grain, 1);
+    if (m_workers.empty() || count <= grain)
+    {
+        function(0, count);
+        return;
+    }
+
+    // A few chunks per thread gives the stealing something to balance with
+    int chunk_count = std::min((count + grain - 1) / grain, get_thread_count() * 4);
+    int chunk_size  = (count + chunk_count - 1) / chunk_count;
+    chunk_count     = (count + chunk_size - 1) / chunk_size;
+
+    std::atomic<int> remaining(chunk_count);
+    int caller_index = (int) m_workers.size();
+
+    for (int chunk = 0; chunk < chunk_count; chunk++)
+    {
+        Job job;
+        job.function  = &function;
+        job.begin     = chunk * chunk_size;
+        job.end       = std::min(job.begin + chunk_size, count);
+        job.remaining = &remaining;
+        job.tag       = Allocations::get_tag();
+
+        m_pending_jobs.fetch_add(1, std::memory_order_relaxed);
+        if (!m_queues[chunk % m_queues.size()]->push(job))
+        {
+            // Queue full: just do it ourselves
+            m_pending_jobs.fetch_sub(1, std::memory_order_relaxed);
+            function(job.begin, job.end);
+            remaining.fetch_sub(1, std::memory_order_release);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_sleep_mutex);
+    }
+    m_wake.notify_all();
+
+    while (remaining.load(std::memory_order_acquire) > 0)
+    {
+        if (!try_run_one(caller_index)) std::this_thread::yield();
+    }
+}
@@ -0,0 +1,93 @@
+//
+//  JobSystem.h
+//  04_AI
+//
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "Allocations.h"
+
+// A small work-stealing job system for data-parallel loops.
+//
+// parallel_for() cuts a range into chunks and deals them out to per-worker
+// queues; each worker pops from the back of its own queue and, once that runs
+// dry, steals from the front of the others'. The calling thread works too, and
+// the call only returns once every chunk is done, so a phase built on it is a
+// barrier: results never depend on how many threads ran it.
+class JobSystem
+{
+public:
+    // A borrowed reference to any callable taking (begin, end). It is two
+    // pointers, so wrapping a lambda never copies or allocates the way a
+    // std::function can; the callable must outlive the parallel_for call.
+    class RangeFunction
+    {
+    private:
+        void *m_callable;
+        void (*m_invoke)(void *callable, int begin, int end);
+
+    public:
+        template <typename Function, typename = typename std::enable_if<
+            !std::is_same<typename std::decay<Function>::type, RangeFunction>::value>::type>
+        RangeFunction(Function &&callable)
+            : m_callable((void *) &callable),
+              m_invoke([](void *callable, int begin, int end)
+              {
+                  (*(typename std::remove_reference<Function>::type *) callable)(begin, end);
+              }) { }
+
+        void operator()(int begin, int end) const { m_invoke(m_callable, begin, end); }
+    };
+
+private:
+    struct Job
+    {
+        const RangeFunction *function = nullptr;
+        int begin = 0, end = 0;
+        std::atomic<int> *remaining = nullptr;
+        AllocationTag tag = ALLOC_JOBS;     // the submitter's, so the work is counted where it came from
+    };
+
+    // Fixed-capacity ring so that submitting never allocates
+    struct WorkQueue
+    {
+        std::mutex mutex;
+        std::vector<Job> jobs;
+        int head = 0, count = 0;
+
+        bool push(const Job &job);
+        bool pop_back(Job *job);
+        bool steal_front(Job *job);
+    };
+
+    std::vector<std::thread> m_workers;
+    std::vector<WorkQueue *> m_queues;      // one per worker, plus one for the caller
+
+    std::mutex m_sleep_mutex;
+    std::condition_variable m_wake;
+    std::atomic<int>  m_pending_jobs{0};
+    std::atomic<bool> m_is_running{true};
+
+    bool const try_run_one(int queue_index);
+    void worker_loop(int queue_index);
+
+public:
+    static constexpr int QUEUE_CAPACITY = 1024;
+    static constexpr int SPINS_BEFORE_SLEEP = 256;
+
+    // worker_count < 0 picks one worker per extra hardware thread
+    explicit JobSystem(int worker_count = -1);
+    ~JobSystem();
+
+    // Runs function over [0, count) in chunks of at least grain items and waits
+    // for all of them. Small ranges run inline on the calling thread.
+    void parallel_for(int count, int grain, const RangeFunction &function);
+
+    int const get_worker_count() const { return (int) m_workers.size(); }
+    int const get_thread_count() const { return (int) m_workers.size() + 1; }
+};
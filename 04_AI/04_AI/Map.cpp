@@ -9,6 +9,9 @@
 **/
 
 #include "Map.h"
+#include <algorithm>
+#include "Profiler.h"
+#include "GL.h"
 
 Map::Map(int width, int height, unsigned int *level_data, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y) : m_width(width), m_height(height),
     m_level_data(level_data), m_texture_id(texture_id), m_tile_size(tile_size), m_tile_count_x(tile_count_x), m_tile_count_y(tile_count_y)
@@ -70,21 +73,31 @@ void Map::build()
 
 void Map::render(ShaderProgram *program)
 {
+    PROFILE_ZONE("Map::render");
     glm::mat4 model_matrix = glm::mat4(1.0f);
     program->set_model_matrix(model_matrix);
     
-    glUseProgram(program->get_program_id());
+    g_gl.use_program(program->get_program_id());
     
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, m_vertices.data());
-    glEnableVertexAttribArray(program->get_position_attribute());
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, m_texture_coordinates.data());
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, m_vertices.data());
+    g_gl.enable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, m_texture_coordinates.data());
+    g_gl.enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
     
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    g_gl.bind_texture(GL_TEXTURE_2D, m_texture_id);
     
-    glDrawArrays(GL_TRIANGLES, 0, (int) m_vertices.size() / 2);
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.draw_arrays(GL_TRIANGLES, 0, (int) m_vertices.size() / 2);
+    g_gl.disable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
+}
+
+MapChunk const Map::get_chunk(int x, int y, int width, int height) const
+{
+    x = std::max(0, std::min(x, m_width));
+    y = std::max(0, std::min(y, m_height));
+    width  = std::max(0, std::min(width, m_width - x));
+    height = std::max(0, std::min(height, m_height - y));
+    return MapChunk(m_level_data + y * m_width + x, m_width, x, y, width, height);
 }
 
 bool Map::is_solid(glm::vec3 position, float *penetration_x, float *penetration_y)
@@ -123,3 +136,85 @@ bool Map::is_solid(glm::vec3 position, float *penetration_x, float *penetration_
     
     return true;
 }
+
+bool Map::raycast(glm::vec3 origin, glm::vec3 direction, float max_distance, RaycastHit *hit) const
+{
+    hit->hit = false;
+    
+    float length = glm::length(glm::vec2(direction));
+    if (length == 0.0f) return false;
+    float dir_x = direction.x / length;
+    float dir_y = direction.y / length;
+    
+    // Work in grid space, where tile (x, y) spans [x, x + 1) and y counts down
+    float grid_x = (origin.x + (m_tile_size / 2)) / m_tile_size;
+    float grid_y = (-origin.y + (m_tile_size / 2)) / m_tile_size;
+    float step_dir_x =  dir_x / m_tile_size;
+    float step_dir_y = -dir_y / m_tile_size;
+    
+    int tile_x = (int) floor(grid_x);
+    int tile_y = (int) floor(grid_y);
+    int step_x = step_dir_x > 0 ? 1 : -1;
+    int step_y = step_dir_y > 0 ? 1 : -1;
+    
+    // Distance along the ray to the next vertical/horizontal grid line, and
+    // between consecutive ones
+    float t_delta_x = step_dir_x != 0.0f ? fabs(1.0f / step_dir_x) : INFINITY;
+    float t_delta_y = step_dir_y != 0.0f ? fabs(1.0f / step_dir_y) : INFINITY;
+    float t_max_x   = step_dir_x != 0.0f ? ((step_x > 0 ? tile_x + 1 - grid_x : grid_x - tile_x) * t_delta_x) : INFINITY;
+    float t_max_y   = step_dir_y != 0.0f ? ((step_y > 0 ? tile_y + 1 - grid_y : grid_y - tile_y) * t_delta_y) : INFINITY;
+    
+    float t = 0.0f;
+    while (t <= max_distance)
+    {
+        bool in_bounds = tile_x >= 0 && tile_x < m_width && tile_y >= 0 && tile_y < m_height;
+        if (in_bounds && m_level_data[tile_y * m_width + tile_x] != 0)
+        {
+            hit->hit      = true;
+            hit->distance = t;
+            hit->tile_x   = tile_x;
+            hit->tile_y   = tile_y;
+            hit->point    = origin + glm::vec3(dir_x, dir_y, 0.0f) * t;
+            return true;
+        }
+        
+        // Once we are outside the map and heading further out, nothing can be hit
+        if (!in_bounds &&
+            ((tile_x < 0 && step_x < 0) || (tile_x >= m_width  && step_x > 0) ||
+             (tile_y < 0 && step_y < 0) || (tile_y >= m_height && step_y > 0)))
+            return false;
+        
+        if (t_max_x < t_max_y)
+        {
+            t        = t_max_x;
+            t_max_x += t_delta_x;
+            tile_x  += step_x;
+        }
+        else
+        {
+            t        = t_max_y;
+            t_max_y += t_delta_y;
+            tile_y  += step_y;
+        }
+    }
+    
+    return false;
+}
+
+bool Map::line_of_sight(glm::vec3 from, glm::vec3 to) const
+{
+    RaycastHit hit;
+    float distance = glm::length(glm::vec2(to - from));
+    if (distance == 0.0f) return true;
+    return !raycast(from, to - from, distance, &hit);
+}
+
+void Map::raycast_batch(const glm::vec3 *origins, const glm::vec3 *directions, const float *max_distances, int count, RaycastHit *hits) const
+{
+    for (int i = 0; i < count; i++) raycast(origins[i], directions[i], max_distances[i], &hits[i]);
+}
+
+void Map::line_of_sight_batch(const glm::vec3 *from, const glm::vec3 *to, int count, bool *visible) const
+{
+    for (int i = 0; i < count; i++) visible[i] = line_of_sight(from[i], to[i]);
+}
@@ -12,11 +12,44 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "Span.h"
 
 
 constexpr float LEFT_EDGE = 5.0f;
 constexpr float RIGHT_EDGE = 14.0f;
 
+struct RaycastHit
+{
+    bool      hit      = false;
+    float     distance = 0.0f;   // along the (normalised) ray, in world units
+    int       tile_x   = -1,
+              tile_y   = -1;
+    glm::vec3 point    = glm::vec3(0.0f);
+};
+
+// A block of a map's tiles, read in place from its level data. Coordinates
+// are relative to the chunk's top-left tile.
+class MapChunk
+{
+private:
+    const unsigned int *m_tiles;    // the top-left tile
+    int m_stride;                   // tiles per row of the whole map
+    int m_x, m_y, m_width, m_height;
+
+public:
+    MapChunk(const unsigned int *tiles, int stride, int x, int y, int width, int height)
+        : m_tiles(tiles), m_stride(stride), m_x(x), m_y(y), m_width(width), m_height(height) { }
+
+    // Where the chunk starts in the map, in tiles
+    int const get_x()      const { return m_x;      }
+    int const get_y()      const { return m_y;      }
+    int const get_width()  const { return m_width;  }
+    int const get_height() const { return m_height; }
+
+    unsigned int const get_tile(int x, int y) const { return m_tiles[y * m_stride + x]; }
+    Span<const unsigned int> const get_row(int y) const { return Span<const unsigned int>(m_tiles + y * m_stride, m_width); }
+};
+
 class Map
 {
 private:
@@ -49,6 +82,15 @@ public:
     void render(ShaderProgram *program);
     bool is_solid(glm::vec3 position, float *penetration_x, float *penetration_y);
     
+    // Grid raycasts (Amanatides & Woo): visits only the tiles the ray crosses,
+    // so the cost grows with distance travelled, not with map size
+    bool raycast(glm::vec3 origin, glm::vec3 direction, float max_distance, RaycastHit *hit) const;
+    bool line_of_sight(glm::vec3 from, glm::vec3 to) const;
+    
+    // Batched forms for many agents at once
+    void raycast_batch(const glm::vec3 *origins, const glm::vec3 *directions, const float *max_distances, int count, RaycastHit *hits) const;
+    void line_of_sight_batch(const glm::vec3 *from, const glm::vec3 *to, int count, bool *visible) const;
+    
     // Getters
     int const get_width()  const  { return m_width;  }
     int const get_height() const  { return m_height; }
@@ -56,15 +98,45 @@ public:
     unsigned int* const get_level_data() const { return m_level_data; }
     GLuint        const get_texture_id() const { return m_texture_id; }
     
+    // The level data with its size, row by row from the top
+    Span<const unsigned int> const get_level() const { return Span<const unsigned int>(m_level_data, (size_t) m_width * m_height); }
+    
+    // 0, i.e. empty, off the map
+    unsigned int const get_tile(int x, int y) const
+    {
+        if (x < 0 || y < 0 || x >= m_width || y >= m_height) return 0;
+        return m_level_data[y * m_width + x];
+    }
+    
     float const get_tile_size()    const { return m_tile_size;    }
     int   const get_tile_count_x() const { return m_tile_count_x; }
     int   const get_tile_count_y() const { return m_tile_count_y; }
     
-    std::vector<float> const get_vertices()            const { return m_vertices;             }
-    std::vector<float> const get_texture_coordinates() const { return m_texture_coordinates; }
+    // The mesh build() made, read in place: two floats per vertex, six vertices per solid tile
+    Span<const float> const get_vertices() const { return Span<const float>(m_vertices.data(), m_vertices.size()); }
+    Span<const float> const get_texture_coordinates() const
+    {
+        return Span<const float>(m_texture_coordinates.data(), m_texture_coordinates.size());
+    }
     
     float const get_left_bound()   const { return m_left_bound;   }
     float const get_right_bound()  const { return m_right_bound;  }
     float const get_top_bound()    const { return m_top_bound;    }
     float const get_bottom_bound() const { return m_bottom_bound; }
+    
+    // ————— CHUNKS ————— //
+    // The width by height block of tiles at (x, y), cut to fit the map
+    MapChunk const get_chunk(int x, int y, int width, int height) const;
+    
+    // Calls function(const MapChunk &) for every chunk_width by chunk_height
+    // block, row by row from the top left; those on the right and bottom
+    // edges are cut to fit
+    template <typename Function>
+    void for_each_chunk(int chunk_width, int chunk_height, Function function) const
+    {
+        if (chunk_width <= 0 || chunk_height <= 0) return;
+        for (int y = 0; y < m_height; y += chunk_height)
+            for (int x = 0; x < m_width; x += chunk_width)
+                function(get_chunk(x, y, chunk_width, chunk_height));
+    }
 };
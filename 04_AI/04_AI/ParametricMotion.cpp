@@ -0,0 +1,246 @@
+//
+//  ParametricMotion.cpp
+//  04_AI
+//
+
+#include "ParametricMotion.h"
+#include <math.h>
+
+namespace
+{
+    constexpr float TWO_PI = 6.28318530718f;
+
+    // (a.x + i a.y) * (b.x + i b.y)
+    inline glm::vec2 complex_multiply(glm::vec2 a, glm::vec2 b)
+    {
+        return glm::vec2(a.x * b.x - a.y * b.y, a.x * b.y + a.y * b.x);
+    }
+
+    inline glm::vec2 phasor_of(float angle) { return glm::vec2(cosf(angle), sinf(angle)); }
+}
+
+ParametricMotion::ParametricMotion()
+{
+    for (int i = 0; i < 4; i++) m_control[i] = glm::vec3(0.0f);
+}
+
+ParametricMotion ParametricMotion::circle(glm::vec3 center, float radius, float start_angle, float end_angle, float angular_speed, bool ping_pong)
+{
+    return ellipse(center, glm::vec2(radius), start_angle, end_angle, angular_speed, ping_pong);
+}
+
+ParametricMotion ParametricMotion::ellipse(glm::vec3 center, glm::vec2 radii, float start_angle, float end_angle, float angular_speed, bool ping_pong)
+{
+    ParametricMotion motion;
+    motion.m_shape     = radii.x == radii.y ? CIRCLE : ELLIPSE;
+    motion.m_center    = center;
+    motion.m_radius    = radii;
+    motion.m_start     = start_angle;
+    motion.m_end       = end_angle;
+    motion.m_rate      = angular_speed;
+    motion.m_ping_pong = ping_pong;
+    motion.reset();
+    return motion;
+}
+
+ParametricMotion ParametricMotion::sine(glm::vec3 origin, float length, float amplitude, float cycles, float speed, bool ping_pong)
+{
+    ParametricMotion motion;
+    motion.m_shape     = SINE_PATH;
+    motion.m_center    = origin;
+    motion.m_radius    = glm::vec2(length, amplitude);
+    motion.m_frequency = cycles * TWO_PI;
+    motion.m_start     = 0.0f;
+    motion.m_end       = 1.0f;
+    motion.m_rate      = speed / length;
+    motion.m_ping_pong = ping_pong;
+    motion.reset();
+    return motion;
+}
+
+ParametricMotion ParametricMotion::bezier(glm::vec3 origin, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float duration, bool ping_pong)
+{
+    ParametricMotion motion;
+    motion.m_shape      = BEZIER;
+    motion.m_center     = origin;
+    motion.m_control[0] = p0;
+    motion.m_control[1] = p1;
+    motion.m_control[2] = p2;
+    motion.m_control[3] = p3;
+    motion.m_start      = 0.0f;
+    motion.m_end        = 1.0f;
+    motion.m_rate       = 1.0f / duration;
+    motion.m_ping_pong  = ping_pong;
+    motion.reset();
+    return motion;
+}
+
+float const ParametricMotion::angle_of(float parameter) const
+{
+    switch (m_shape)
+    {
+        case CIRCLE:
+        case ELLIPSE:
+            return parameter;
+
+        case SINE_PATH:
+            return parameter * m_frequency;
+
+        default:
+            return 0.0f;
+    }
+}
+
+glm::vec3 const ParametricMotion::shape_at(float parameter, float cos_angle, float sin_angle) const
+{
+    switch (m_shape)
+    {
+        case CIRCLE:
+        case ELLIPSE:
+            return m_center + glm::vec3(m_radius.x * cos_angle, m_radius.y * sin_angle, 0.0f);
+
+        case SINE_PATH:
+            return m_center + glm::vec3(parameter * m_radius.x, m_radius.y * sin_angle, 0.0f);
+
+        case BEZIER:
+        {
+            float u  = parameter;
+            float v  = 1.0f - u;
+            return m_center + v * v * v * m_control[0] + 3.0f * v * v * u * m_control[1]
+                            + 3.0f * v * u * u * m_control[2] + u * u * u * m_control[3];
+        }
+
+        default:
+            return m_center;
+    }
+}
+
+void ParametricMotion::reset()
+{
+    m_time      = 0.0;
+    m_parameter = m_start;
+    m_direction = 1.0f;
+    m_phasor    = phasor_of(angle_of(m_start));
+    m_rotor_step = -1.0f;
+    m_steps_since_anchor = 0;
+
+    // Reflecting an angle a about a bound b gives 2b - a, i.e. e^{i2b} * conj(e^{ia});
+    // wrapping subtracts the span. Both are constant for the path, so precompute them
+    m_reflect_start = phasor_of(2.0f * angle_of(m_start));
+    m_reflect_end   = phasor_of(2.0f * angle_of(m_end));
+    m_wrap          = phasor_of(angle_of(m_start) - angle_of(m_end));
+}
+
+void ParametricMotion::advance(float delta_time)
+{
+    float delta = m_rate * delta_time;
+
+    if (delta_time != m_rotor_step)
+    {
+        m_rotor      = phasor_of(angle_of(delta) - angle_of(0.0f));
+        m_rotor_step = delta_time;
+    }
+
+    m_time      += delta_time;
+    m_parameter += m_direction * delta;
+    m_phasor     = complex_multiply(m_phasor, glm::vec2(m_rotor.x, m_direction * m_rotor.y));
+
+    if (m_ping_pong)
+    {
+        if (m_parameter > m_end)
+        {
+            m_parameter = 2.0f * m_end - m_parameter;
+            m_phasor    = complex_multiply(m_reflect_end, glm::vec2(m_phasor.x, -m_phasor.y));
+            m_direction = -1.0f;
+        }
+        else if (m_parameter < m_start)
+        {
+            m_parameter = 2.0f * m_start - m_parameter;
+            m_phasor    = complex_multiply(m_reflect_start, glm::vec2(m_phasor.x, -m_phasor.y));
+            m_direction = 1.0f;
+        }
+    }
+    else if (m_parameter > m_end)
+    {
+        m_parameter -= m_end - m_start;
+        m_phasor     = complex_multiply(m_phasor, m_wrap);
+    }
+
+    // A step longer than the span can overshoot by more than one wrap or
+    // bounce; the closed form handles any distance, so fall back on it
+    if (m_parameter < m_start || m_parameter > m_end)
+    {
+        seek(m_time);
+        return;
+    }
+
+    // Repeated adds and multiplies slowly drift from the exact path, so every so
+    // often we re-anchor on the closed form; that costs one sin/cos per interval
+    if (++m_steps_since_anchor >= REANCHOR_INTERVAL) seek(m_time);
+}
+
+glm::vec3 const ParametricMotion::get_position() const
+{
+    return shape_at(m_parameter, m_phasor.x, m_phasor.y);
+}
+
+float const ParametricMotion::parameter_at(double time, float *direction) const
+{
+    float  span     = m_end - m_start;
+    double distance = m_rate * time;
+
+    if (!m_ping_pong)
+    {
+        if (direction != nullptr) *direction = 1.0f;
+        return m_start + (float) fmod(distance, span);
+    }
+
+    // Triangle wave with period 2 * span
+    float phase = (float) fmod(distance, 2.0 * span);
+    if (phase <= span)
+    {
+        if (direction != nullptr) *direction = 1.0f;
+        return m_start + phase;
+    }
+    if (direction != nullptr) *direction = -1.0f;
+    return m_end - (phase - span);
+}
+
+glm::vec3 const ParametricMotion::position_at(double time) const
+{
+    float parameter = parameter_at(time);
+    float angle     = angle_of(parameter);
+    return shape_at(parameter, cosf(angle), sinf(angle));
+}
+
+void ParametricMotion::seek(double time)
+{
+    m_time      = time;
+    m_parameter = parameter_at(time, &m_direction);
+    m_phasor    = phasor_of(angle_of(m_parameter));
+    m_steps_since_anchor = 0;
+}
+
+void ParametricMotion::save_state(StateWriter *writer) const
+{
+    writer->write(m_center);
+    writer->write(m_time);
+    writer->write(m_parameter);
+    writer->write(m_direction);
+    writer->write(m_phasor);
+    writer->write(m_rotor);
+    writer->write(m_rotor_step);
+    writer->write(m_steps_since_anchor);
+}
+
+void ParametricMotion::load_state(StateReader *reader)
+{
+    reader->read(&m_center);
+    reader->read(&m_time);
+    reader->read(&m_parameter);
+    reader->read(&m_direction);
+    reader->read(&m_phasor);
+    reader->read(&m_rotor);
+    reader->read(&m_rotor_step);
+    reader->read(&m_steps_since_anchor);
+}
@@ -0,0 +1,88 @@
+//
+//  ParametricMotion.h
+//  04_AI
+//
+
+#pragma once
+#include "glm/glm.hpp"
+#include "Snapshot.h"
+
+enum PathShape { CIRCLE, ELLIPSE, SINE_PATH, BEZIER };
+
+// A closed-form path for entities that do not need physics (e.g. the vulture).
+//
+// The path is driven by a single parameter that sweeps [start, end] at a fixed
+// rate, either once and then wrapping, or back and forth. advance() steps it
+// incrementally (a complex multiply per step instead of sin/cos, re-anchored on
+// the closed form every REANCHOR_INTERVAL steps, or whenever one step goes past
+// an end more than once), while position_at() evaluates the same path directly
+// for any time t, so a flyer can be fast-forwarded without replaying every
+// step.
+class ParametricMotion
+{
+private:
+    PathShape m_shape = CIRCLE;
+
+    glm::vec3 m_center = glm::vec3(0.0f);
+    glm::vec2 m_radius = glm::vec2(1.0f);     // circle/ellipse radii, or sine (length, amplitude)
+    glm::vec3 m_control[4];                   // cubic Bezier control points, relative to m_center
+    float     m_frequency = 1.0f;             // sine: radians per unit of parameter
+
+    float m_start = 0.0f,
+          m_end   = 1.0f,
+          m_rate  = 1.0f;                     // parameter units per second
+    bool  m_ping_pong = true;
+
+    // ————— INCREMENTAL STATE ————— //
+    double    m_time      = 0.0;   // double so long runs stay in step with position_at
+    float     m_parameter = 0.0f;
+    float     m_direction = 1.0f;
+    glm::vec2 m_phasor    = glm::vec2(1.0f, 0.0f);  // (cos, sin) of the current angle
+    glm::vec2 m_rotor     = glm::vec2(1.0f, 0.0f);  // (cos, sin) of one step's angle
+    float     m_rotor_step = -1.0f;                 // the delta time m_rotor was built for
+    glm::vec2 m_reflect_start = glm::vec2(1.0f, 0.0f),
+              m_reflect_end   = glm::vec2(1.0f, 0.0f),
+              m_wrap          = glm::vec2(1.0f, 0.0f);
+    int       m_steps_since_anchor = 0;
+
+    float const angle_of(float parameter) const;
+    glm::vec3 const shape_at(float parameter, float cos_angle, float sin_angle) const;
+
+public:
+    static constexpr int REANCHOR_INTERVAL = 64;
+
+    ParametricMotion();
+
+    // ————— FACTORIES ————— //
+    static ParametricMotion circle(glm::vec3 center, float radius, float start_angle, float end_angle, float angular_speed, bool ping_pong);
+    static ParametricMotion ellipse(glm::vec3 center, glm::vec2 radii, float start_angle, float end_angle, float angular_speed, bool ping_pong);
+    static ParametricMotion sine(glm::vec3 origin, float length, float amplitude, float cycles, float speed, bool ping_pong);
+    static ParametricMotion bezier(glm::vec3 origin, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, float duration, bool ping_pong);
+
+    // ————— METHODS ————— //
+    void reset();
+    void advance(float delta_time);
+    glm::vec3 const get_position() const;
+
+    // Deterministic direct evaluation; does not touch the incremental state
+    float const parameter_at(double time, float *direction = nullptr) const;
+    glm::vec3 const position_at(double time) const;
+
+    // Jump the incremental state to an arbitrary time
+    void seek(double time);
+
+    // Snapshots hold the center and the incremental state; the shape is fixed
+    // at construction and is not saved
+    void save_state(StateWriter *writer) const;
+    void load_state(StateReader *reader);
+
+    // ————— GETTERS ————— //
+    PathShape const get_shape()     const { return m_shape;     }
+    glm::vec3 const get_center()    const { return m_center;    }
+    float     const get_parameter() const { return m_parameter; }
+    float     const get_direction() const { return m_direction; }
+    double    const get_time()      const { return m_time;      }
+
+    // ————— SETTERS ————— //
+    void const set_center(glm::vec3 new_center) { m_center = new_center; }
+};
@@ -0,0 +1,148 @@
+//
+//  Perception.cpp
+//  04_AI
+//
+
+#include "Perception.h"
+#include <algorithm>
+#include <math.h>
+#include "Entity.h"
+#include "JobSystem.h"
+#include "Map.h"
+
+void Perception::update(const Entity *agents, int agent_count, const Entity *player, const Map *map, JobSystem *jobs)
+{
+    m_percepts.resize(agent_count);
+
+    m_agents      = agents;
+    m_agent_count = agent_count;
+    m_map         = map;
+    m_is_broad_phase_built.store(false, std::memory_order_relaxed);
+
+    glm::vec3 player_position = player->get_position();
+
+    auto perceive = [&](int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            Percept &percept = m_percepts[i];
+            const Entity &agent = agents[i];
+            if (!agent.get_activation_status())
+            {
+                percept = Percept();
+                percept.distance = INFINITY;
+                continue;
+            }
+
+            glm::vec3 eye = agent.get_eye_position();
+            percept.to_player   = glm::vec2(player_position - eye);
+            percept.distance    = glm::length(percept.to_player);
+
+            // Raycasts are the expensive part, so only agents in range get one
+            percept.sees_player = percept.distance <= m_sight_range &&
+                                  (map == nullptr || map->line_of_sight(eye, player_position));
+        }
+    };
+
+    if (jobs != nullptr) jobs->parallel_for(agent_count, JOB_GRAIN, perceive);
+    else perceive(0, agent_count);
+}
+
+int const Perception::cell_of(glm::vec3 position) const
+{
+    int cell_x = (int) floor((position.x - m_grid_left) / m_cell_size);
+    int cell_y = (int) floor((m_grid_top - position.y) / m_cell_size);
+
+    // Anything off the map is filed under the nearest edge cell
+    cell_x = std::min(std::max(cell_x, 0), m_grid_width - 1);
+    cell_y = std::min(std::max(cell_y, 0), m_grid_height - 1);
+    return cell_y * m_grid_width + cell_x;
+}
+
+void Perception::build_broad_phase() const
+{
+    if (m_is_broad_phase_built.load(std::memory_order_acquire)) return;
+    std::lock_guard<std::mutex> lock(m_broad_phase_mutex);
+    if (m_is_broad_phase_built.load(std::memory_order_relaxed)) return;
+
+    const Entity *agents = m_agents;
+    int agent_count      = m_agent_count;
+    const Map *map       = m_map;
+
+    float right  = 1.0f,
+          bottom = -1.0f;
+    m_grid_left = 0.0f;
+    m_grid_top  = 0.0f;
+    if (map != nullptr)
+    {
+        m_grid_left = map->get_left_bound();
+        m_grid_top  = map->get_top_bound();
+        right       = map->get_right_bound();
+        bottom      = map->get_bottom_bound();
+    }
+    m_grid_width  = std::max(1, (int) ceil((right - m_grid_left) / m_cell_size));
+    m_grid_height = std::max(1, (int) ceil((m_grid_top - bottom) / m_cell_size));
+
+    int cell_count = m_grid_width * m_grid_height;
+    m_cell_start.assign(cell_count + 1, 0);
+    m_cell_cursor.resize(cell_count);
+    m_cell_of_agent.resize(agent_count);
+    m_agent_positions.resize(agent_count);
+
+    // Counting sort of active agents into cells
+    for (int i = 0; i < agent_count; i++)
+    {
+        m_agent_positions[i] = agents[i].get_position();
+        if (!agents[i].get_activation_status())
+        {
+            m_cell_of_agent[i] = -1;
+            continue;
+        }
+        m_cell_of_agent[i] = cell_of(m_agent_positions[i]);
+        m_cell_start[m_cell_of_agent[i] + 1]++;
+    }
+    for (int cell = 0; cell < cell_count; cell++) m_cell_start[cell + 1] += m_cell_start[cell];
+
+    m_cell_agents.resize(m_cell_start[cell_count]);
+    std::copy(m_cell_start.begin(), m_cell_start.end() - 1, m_cell_cursor.begin());
+    for (int i = 0; i < agent_count; i++)
+        if (m_cell_of_agent[i] >= 0) m_cell_agents[m_cell_cursor[m_cell_of_agent[i]]++] = i;
+
+    m_is_broad_phase_built.store(true, std::memory_order_release);
+}
+
+int const Perception::query_neighbours(int agent, float radius, int *out, int max_count) const
+{
+    build_broad_phase();
+    if (agent < 0 || agent >= (int) m_cell_of_agent.size() || m_cell_of_agent[agent] < 0) return 0;
+
+    glm::vec3 center = m_agent_positions[agent];
+    int min_cell = cell_of(center + glm::vec3(-radius, radius, 0.0f));
+    int max_cell = cell_of(center + glm::vec3(radius, -radius, 0.0f));
+    int min_x = min_cell % m_grid_width, min_y = min_cell / m_grid_width;
+    int max_x = max_cell % m_grid_width, max_y = max_cell / m_grid_width;
+
+    float radius_squared = radius * radius;
+    int count = 0;
+
+    for (int cell_y = min_y; cell_y <= max_y; cell_y++)
+    {
+        for (int cell_x = min_x; cell_x <= max_x; cell_x++)
+        {
+            int cell = cell_y * m_grid_width + cell_x;
+            for (int k = m_cell_start[cell]; k < m_cell_start[cell + 1]; k++)
+            {
+                int other = m_cell_agents[k];
+                if (other == agent) continue;
+
+                glm::vec2 offset = glm::vec2(m_agent_positions[other] - center);
+                if (glm::dot(offset, offset) > radius_squared) continue;
+
+                if (count == max_count) return count;
+                out[count++] = other;
+            }
+        }
+    }
+
+    return count;
+}
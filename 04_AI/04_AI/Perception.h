@@ -0,0 +1,85 @@
+//
+//  Perception.h
+//  04_AI
+//
+
+#pragma once
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include "glm/glm.hpp"
+
+class Entity;
+class Map;
+class JobSystem;
+
+// What one agent knows about the player this step
+struct Percept
+{
+    glm::vec2 to_player   = glm::vec2(0.0f);  // player position minus the agent's eye
+    float     distance    = 0.0f;
+    bool      sees_player = false;
+};
+
+// Per-step perception pass.
+//
+// Every query an AI behaviour makes about the player (distance, direction,
+// line of sight) is answered once per agent per step into a flat table, which
+// the behaviours then read by agent index. Agent-to-agent queries go through a
+// uniform grid broad-phase, built by the first such query after each update so
+// that steps which never ask pay nothing for it.
+class Perception
+{
+private:
+    std::vector<Percept> m_percepts;
+
+    // ————— BROAD-PHASE ————— //
+    // Cached from the last update() for the lazy build below
+    const Entity *m_agents      = nullptr;
+    int           m_agent_count = 0;
+    const Map    *m_map         = nullptr;
+
+    float m_cell_size = 2.0f;
+    mutable float m_grid_left = 0.0f,
+                  m_grid_top  = 0.0f;
+    mutable int   m_grid_width  = 0,
+                  m_grid_height = 0;
+
+    mutable std::vector<int>       m_cell_of_agent;
+    mutable std::vector<int>       m_cell_start;    // prefix sums into m_cell_agents
+    mutable std::vector<int>       m_cell_agents;
+    mutable std::vector<int>       m_cell_cursor;
+    mutable std::vector<glm::vec3> m_agent_positions;
+
+    // Queries can come from several jobs at once, so the first one builds the
+    // grid under the lock and the rest wait for it
+    mutable std::atomic<bool> m_is_broad_phase_built{false};
+    mutable std::mutex        m_broad_phase_mutex;
+
+    float m_sight_range = 16.0f;
+
+    int const cell_of(glm::vec3 position) const;
+    void build_broad_phase() const;
+
+public:
+    static constexpr int JOB_GRAIN = 256;
+
+    // ————— METHODS ————— //
+    void update(const Entity *agents, int agent_count, const Entity *player, const Map *map, JobSystem *jobs = nullptr);
+
+    // Writes the indices of active agents within radius of agent into out (at
+    // most max_count of them, excluding the agent itself) and returns how many.
+    // Positions are taken when the first query after update() builds the grid.
+    int const query_neighbours(int agent, float radius, int *out, int max_count) const;
+
+    // ————— GETTERS ————— //
+    const Percept &get(int agent) const { return m_percepts[agent]; }
+    const Percept *get_table()    const { return m_percepts.data(); }
+    int   const get_agent_count() const { return (int) m_percepts.size(); }
+    float const get_cell_size()   const { return m_cell_size; }
+    float const get_sight_range() const { return m_sight_range; }
+
+    // ————— SETTERS ————— //
+    void const set_cell_size(float new_cell_size)     { m_cell_size = new_cell_size; m_is_broad_phase_built = false; }
+    void const set_sight_range(float new_sight_range) { m_sight_range = new_sight_range; }
+};
@@ -0,0 +1,116 @@
+//
+//  PerfOverlay.cpp
+//  04_AI
+//
+
+#include "PerfOverlay.h"
+#include <algorithm>
+#include <cstdio>
+#include "glm/gtc/matrix_transform.hpp"
+#include "Utility.h"
+#include "GL.h"
+
+// The screen is 10 by 7.5 units with the origin in the middle
+constexpr float LEFT = -4.8f, TOP = 3.55f;
+constexpr float TEXT_SIZE = 0.2f, TEXT_SPACING = -0.06f, LINE_HEIGHT = 0.24f;
+
+constexpr float BAR_WIDTH = 0.03f;
+constexpr float GRAPH_HEIGHT = 1.0f;            // for two frames' budget
+constexpr float GRAPH_MS = 2.0f * PerfOverlay::BUDGET_MS;
+
+PerfOverlay::PerfOverlay(GLuint font_texture_id) : m_font_texture_id(font_texture_id)
+{
+    const unsigned char texels[] = {
+        80, 220, 80, 200,
+        230, 60, 60, 220
+    };
+
+    g_gl.gen_textures(1, &m_bar_texture_id);
+    g_gl.bind_texture(GL_TEXTURE_2D, m_bar_texture_id);
+    g_gl.tex_image_2d(GL_TEXTURE_2D, 0, GL_RGBA, 2, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+    g_gl.tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    g_gl.tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+}
+
+PerfOverlay::~PerfOverlay()
+{
+    g_gl.delete_textures(1, &m_bar_texture_id);
+}
+
+void PerfOverlay::push_frame(const FrameCounters &frame)
+{
+    m_newest = (m_newest + 1) % HISTORY_SIZE;
+    m_frame_ms[m_newest] = frame.frame_ns / 1e6f;
+    m_last_frame = frame;
+}
+
+// One bar per remembered frame, oldest on the left, all in one draw
+void PerfOverlay::draw_graph(ShaderProgram *program, float left, float bottom)
+{
+    float vertices[HISTORY_SIZE * 12];
+    float tex_coords[HISTORY_SIZE * 12];
+
+    for (int i = 0; i < HISTORY_SIZE; i++)
+    {
+        float frame_ms = m_frame_ms[(m_newest + 1 + i) % HISTORY_SIZE];
+        float height = std::min(frame_ms, GRAPH_MS) / GRAPH_MS * GRAPH_HEIGHT;
+        float x0 = left + i * BAR_WIDTH, x1 = x0 + BAR_WIDTH * 0.8f;
+        float y0 = bottom, y1 = bottom + height;
+        float u = frame_ms > BUDGET_MS ? 0.75f : 0.25f;
+
+        const float bar[] = { x0, y0, x1, y0, x1, y1, x0, y0, x1, y1, x0, y1 };
+        std::copy(bar, bar + 12, vertices + i * 12);
+        for (int j = 0; j < 6; j++)
+        {
+            tex_coords[i * 12 + j * 2]     = u;
+            tex_coords[i * 12 + j * 2 + 1] = 0.5f;
+        }
+    }
+
+    program->set_model_matrix(glm::mat4(1.0f));
+    g_gl.bind_texture(GL_TEXTURE_2D, m_bar_texture_id);
+
+    g_gl.vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    g_gl.enable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    g_gl.enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
+
+    g_gl.draw_arrays(GL_TRIANGLES, 0, HISTORY_SIZE * 6);
+
+    g_gl.disable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
+}
+
+void PerfOverlay::render(ShaderProgram *program, const glm::mat4 &view_matrix)
+{
+    if (!m_is_visible) return;
+    ALLOCATION_TAG(ALLOC_TOOLS);
+
+    FrameCounters before = FrameStats::get_current();
+    program->set_view_matrix(glm::mat4(1.0f));
+
+    float worst_ms = *std::max_element(m_frame_ms, m_frame_ms + HISTORY_SIZE);
+
+    char lines[6][64];
+    snprintf(lines[0], sizeof(lines[0]), "frame %.2f ms  worst %.2f", m_frame_ms[m_newest], worst_ms);
+    snprintf(lines[1], sizeof(lines[1]), "steps %d", m_last_frame.fixed_steps);
+    snprintf(lines[2], sizeof(lines[2]), "draws %d  binds %d", m_last_frame.draw_calls, m_last_frame.texture_binds);
+    snprintf(lines[3], sizeof(lines[3]), "uniforms %d", m_last_frame.uniform_uploads);
+    snprintf(lines[4], sizeof(lines[4]), "entities %d/%d", m_active_entity_count, m_entity_count);
+
+    // Which subsystem allocated the most, if any did
+    int heaviest_tag = 0;
+    for (int tag = 1; tag < ALLOCATION_TAG_COUNT; tag++)
+        if (m_last_frame.tag_allocations[tag] > m_last_frame.tag_allocations[heaviest_tag]) heaviest_tag = tag;
+    snprintf(lines[5], sizeof(lines[5]), "allocs %lld  %lld bytes  %s", m_last_frame.allocations, m_last_frame.allocated_bytes,
+             m_last_frame.allocations > 0 ? Allocations::get_tag_name((AllocationTag) heaviest_tag) : "");
+
+    for (int i = 0; i < 6; i++)
+        Utility::draw_text(program, m_font_texture_id, lines[i], TEXT_SIZE, TEXT_SPACING,
+                           glm::vec3(LEFT, TOP - i * LINE_HEIGHT, 0.0f));
+
+    draw_graph(program, LEFT - TEXT_SIZE / 2.0f, TOP - 6 * LINE_HEIGHT - GRAPH_HEIGHT);
+
+    program->set_view_matrix(view_matrix);
+    FrameStats::discard_since(before);
+}
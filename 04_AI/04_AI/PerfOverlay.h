@@ -0,0 +1,58 @@
+//
+//  PerfOverlay.h
+//  04_AI
+//
+
+#pragma once
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "ShaderProgram.h"
+#include "FrameStats.h"
+
+// A toggleable readout drawn over the game in screen space: a graph of recent
+// frame times against the 60 Hz budget, and the last frame's fixed steps,
+// draw calls, texture binds, uniform uploads, live entities and allocations.
+//
+// It draws with the bitmap font and one small texture for the graph's bars,
+// and takes its own draws and allocations back out of the counters.
+class PerfOverlay
+{
+public:
+    static constexpr int HISTORY_SIZE = 120;
+    static constexpr float BUDGET_MS = 1000.0f / 60.0f;
+
+private:
+    GLuint m_font_texture_id;
+    GLuint m_bar_texture_id;        // two texels: within budget, over it
+
+    bool m_is_visible = false;
+
+    float m_frame_ms[HISTORY_SIZE] = {};
+    int m_newest = 0;
+    FrameCounters m_last_frame;
+
+    int m_entity_count = 0, m_active_entity_count = 0;
+
+    void draw_graph(ShaderProgram *program, float left, float bottom);
+
+public:
+    PerfOverlay(GLuint font_texture_id);
+    ~PerfOverlay();
+
+    void toggle() { m_is_visible = !m_is_visible; }
+    bool const get_visibility() const { return m_is_visible; }
+
+    // Called once per frame, after the frame has ended
+    void push_frame(const FrameCounters &frame);
+    void set_entity_counts(int active_entity_count, int entity_count) { m_active_entity_count = active_entity_count; m_entity_count = entity_count; }
+
+    // Draws over whatever is on screen, restoring the view matrix afterwards
+    void render(ShaderProgram *program, const glm::mat4 &view_matrix);
+};
@@ -0,0 +1,138 @@
+//
+//  Profiler.cpp
+//  04_AI
+//
+
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include "Allocations.h"
+
+std::atomic<bool> Profiler::s_is_enabled{false};
+
+// Taken only to register a thread, name it or export; never to record
+static std::mutex g_registry_mutex;
+
+std::vector<Profiler::ThreadBuffer *> &Profiler::registry()
+{
+    static std::vector<ThreadBuffer *> buffers;
+    return buffers;
+}
+
+Profiler::ThreadBuffer *const Profiler::thread_buffer()
+{
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (buffer) return buffer;
+    ALLOCATION_TAG(ALLOC_TOOLS);
+
+    buffer = new ThreadBuffer;
+    buffer->events.resize(EVENTS_PER_THREAD);
+
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    registry().push_back(buffer);
+    buffer->thread_id = (int) registry().size();
+    return buffer;
+}
+
+int64_t const Profiler::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(const char *name, int64_t start_ns, int64_t end_ns)
+{
+    ThreadBuffer *buffer = thread_buffer();
+    int count = buffer->count.load(std::memory_order_relaxed);
+    if (count == EVENTS_PER_THREAD)
+    {
+        buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->events[count] = { name, start_ns, end_ns };
+    buffer->count.store(count + 1, std::memory_order_release);
+}
+
+void Profiler::set_thread_name(const char *name)
+{
+    ThreadBuffer *buffer = thread_buffer();
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    buffer->name = name;
+}
+
+// Names are string literals, but quotes and backslashes would still break the
+// JSON
+static void write_json_string(FILE *file, const char *text)
+{
+    fputc('"', file);
+    for (; *text; text++)
+    {
+        if (*text == '"' || *text == '\\') fputc('\\', file);
+        fputc(*text, file);
+    }
+    fputc('"', file);
+}
+
+bool Profiler::write_chrome_trace(const char *filepath)
+{
+    ALLOCATION_TAG(ALLOC_TOOLS);
+    FILE *file = fopen(filepath, "w");
+    if (!file) return false;
+
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+
+    // Timestamps are made relative to the first zone so they stay readable
+    int64_t origin_ns = INT64_MAX;
+    for (ThreadBuffer *buffer : registry())
+    {
+        int count = buffer->count.load(std::memory_order_acquire);
+        for (int i = 0; i < count; i++) origin_ns = std::min(origin_ns, buffer->events[i].start_ns);
+    }
+
+    // Trace Event times are in microseconds; three decimals keep the
+    // nanoseconds
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool is_first = true;
+    for (ThreadBuffer *buffer : registry())
+    {
+        if (!buffer->name.empty())
+        {
+            fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", is_first ? "" : ",", buffer->thread_id);
+            write_json_string(file, buffer->name.c_str());
+            fprintf(file, "}}");
+            is_first = false;
+        }
+
+        int count = buffer->count.load(std::memory_order_acquire);
+        for (int i = 0; i < count; i++)
+        {
+            const Event &event = buffer->events[i];
+            fprintf(file, "%s\n{\"name\":", is_first ? "" : ",");
+            write_json_string(file, event.name);
+            fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}", buffer->thread_id,
+                    (event.start_ns - origin_ns) / 1000.0, (event.end_ns - event.start_ns) / 1000.0);
+            is_first = false;
+        }
+    }
+    fprintf(file, "\n]}\n");
+
+    return fclose(file) == 0;
+}
+
+long long const Profiler::get_event_count()
+{
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    long long total = 0;
+    for (ThreadBuffer *buffer : registry()) total += buffer->count.load(std::memory_order_acquire);
+    return total;
+}
+
+long long const Profiler::get_dropped_count()
+{
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    long long total = 0;
+    for (ThreadBuffer *buffer : registry()) total += buffer->dropped.load(std::memory_order_relaxed);
+    return total;
+}
@@ -0,0 +1,94 @@
+//
+//  Profiler.h
+//  04_AI
+//
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A scoped profiler whose zones can be written out as a Chrome trace
+// (chrome://tracing or ui.perfetto.dev).
+//
+// PROFILE_ZONE("name") at the top of a block times the rest of the block. Each
+// thread appends finished zones to its own fixed-size buffer, so recording
+// takes no lock and never allocates; the buffer is only allocated, and the
+// thread registered, the first time it records. A full buffer drops new
+// zones rather than growing. While the profiler is off a zone costs one
+// relaxed load.
+//
+// Zone names are kept as pointers, so they must be string literals.
+class Profiler
+{
+public:
+    static constexpr int EVENTS_PER_THREAD = 1 << 18;
+
+    struct Event
+    {
+        const char *name;
+        int64_t start_ns, end_ns;
+    };
+
+private:
+    // Written only by its own thread; count is published with release so the
+    // exporter sees every event below it complete
+    struct ThreadBuffer
+    {
+        std::vector<Event> events;
+        std::atomic<int> count{0};
+        std::atomic<long long> dropped{0};
+        int thread_id = 0;
+        std::string name;
+    };
+
+    static std::atomic<bool> s_is_enabled;
+
+    // Every thread that has recorded, in the order they first did; buffers
+    // outlive their threads so that exited workers still get exported
+    static std::vector<ThreadBuffer *> &registry();
+    static ThreadBuffer *const thread_buffer();
+
+public:
+    static void set_enabled(bool is_enabled) { s_is_enabled.store(is_enabled, std::memory_order_relaxed); }
+    static bool const is_enabled() { return s_is_enabled.load(std::memory_order_relaxed); }
+
+    // Nanoseconds on the steady clock
+    static int64_t const now_ns();
+
+    static void record(const char *name, int64_t start_ns, int64_t end_ns);
+
+    // Shown as the thread's track name in the trace
+    static void set_thread_name(const char *name);
+
+    // Every zone recorded so far, as Trace Event JSON; false if the file
+    // could not be written. Zones still open are left out.
+    static bool write_chrome_trace(const char *filepath);
+
+    static long long const get_event_count();
+    static long long const get_dropped_count();
+};
+
+class ProfileZone
+{
+private:
+    const char *m_name;
+    int64_t m_start_ns;     // -1 when the profiler was off as the zone opened
+
+public:
+    explicit ProfileZone(const char *name) : m_name(name), m_start_ns(Profiler::is_enabled() ? Profiler::now_ns() : -1) {}
+    ~ProfileZone() { if (m_start_ns >= 0) Profiler::record(m_name, m_start_ns, Profiler::now_ns()); }
+
+    ProfileZone(const ProfileZone &) = delete;
+    ProfileZone &operator=(const ProfileZone &) = delete;
+};
+
+#define PROFILE_JOIN_(a, b) a##b
+#define PROFILE_JOIN(a, b) PROFILE_JOIN_(a, b)
+
+#ifdef PROFILER_DISABLED
+#define PROFILE_ZONE(name)
+#else
+#define PROFILE_ZONE(name) ProfileZone PROFILE_JOIN(profile_zone_, __LINE__)(name)
+#endif
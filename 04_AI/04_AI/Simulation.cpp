@@ -0,0 +1,294 @@
+//
+//  Simulation.cpp
+//  04_AI
+//
+
+#include "Simulation.h"
+#include "Allocations.h"
+
+unsigned int LEVEL_1_DATA[] = {
+    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
+    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
+    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
+    19, 0, 0, 0, 14, 15, 16, 0, 0, 0, 0, 14, 16, 0, 0, 0, 0, 0, 0, 19,
+    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
+    19, 0, 0, 0, 0, 0, 0, 1, 3, 0, 0, 0, 0, 0, 0, 1, 3, 0, 0, 19,
+    19, 2, 2, 2, 2, 2, 7, 8, 10, 11, 2, 2, 2, 2, 7, 8, 10, 11, 2, 19,
+    19, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 19
+};
+
+Simulation::Simulation(JobSystem *jobs) : m_jobs(jobs) { }
+
+Simulation::~Simulation()
+{
+    delete[] m_enemies;
+    delete   m_ai_machine;
+    delete   m_perception;
+    delete   m_player;
+    delete   m_map;
+}
+
+bool Simulation::initialise(const char *ai_table_filepath, const SimulationTextures &textures)
+{
+    delete[] m_enemies;
+    delete   m_ai_machine;
+    delete   m_perception;
+    delete   m_player;
+    delete   m_map;
+
+    m_result              = NONE;
+    m_shooter_is_active   = true;
+    m_current_enemy_count = ENEMY_COUNT;
+    m_step_count          = 0;
+    m_player_jumped       = false;
+
+    // ————— MAP SET-UP ————— //
+    m_map = new Map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, textures.tileset, 1.0f, 5, 4);
+
+    // ------ PLAYER ------//
+    int player_walking_animation[4][4] =
+    {
+    { 4, 5, 6, 7 },  // for player to move to the left,
+    { 12, 13, 14, 15 }, // for player to move to the right,
+    { 0, 1, 2, 3 }, // for player to move upwards,
+    { 8, 9, 10, 11 }   // for player to move downwards
+    };
+
+    glm::vec3 gravity = glm::vec3(0.0f, -4.905f, 0.0f);
+
+    m_player = new Entity(
+        textures.player,           // texture id
+        3.0f,                      // speed
+        gravity,              // acceleration
+        3.0f,                      // jumping power
+        player_walking_animation,  // animation index sets
+        0.0f,                      // animation time
+        4,                         // animation frame amount
+        0,                         // current animation index
+        4,                         // animation column amount
+        4,                         // animation row amount
+        0.5f,                      // width
+        0.5f,                       // height
+        PLAYER,
+        NOTYPE,
+        NOSTATE
+    );
+    m_player->set_position(glm::vec3(7.0f, -4.0f, 0.0f));
+    // Jumping
+    m_player->set_jumping_power(4.5f);
+    m_player->set_enemy_count(ENEMY_COUNT);
+
+    m_enemies = new Entity[ENEMY_COUNT];
+
+    int enemy_animation[4][4] =
+    {
+    { 0, 1, 2, 3 },     // fly left,
+    { 4, 5, 6, 7 }, // fly right,
+    { 8, 9, 10, 11 },     // die left,
+    { 12, 13, 14, 15 }    // die right
+    };
+
+    // ----- VULTURE ----- //
+    m_enemies[0] = Entity(textures.vulture, -1.0f, glm::vec3(0.0f), 0.0f, enemy_animation, 0.0f, 4, 0, 4, 4, 1.0f, 1.0f, ENEMY, FLYER, IDLE);
+    m_enemies[0].set_position(glm::vec3(8.0f, -0.5f, 0.0f));
+
+    // ----- FOX ----- //
+    m_enemies[1] = Entity(textures.fox, 1.0f, gravity, 0.0f, enemy_animation, 0.0f, 4, 0, 4, 4, 1.5f, 1.5f, ENEMY, GUARD, IDLE);
+    m_enemies[1].set_position(glm::vec3(2.0f, -5.0f, 0.0f));
+
+    // ----- HUNTER ----- //
+    m_enemies[2] = Entity(textures.hunter, 1.0f, 1.0f, 1.0f, ENEMY, SHOOTER, IDLE);
+    m_enemies[2].set_position(glm::vec3(15.5f, -4.0f, 0.0f));
+
+    // ----- BULLET ----- //
+    m_enemies[3] = Entity(textures.bullet, 2.0f, 0.3f, 0.3f, ENEMY, BULLET, IDLE);
+    m_enemies[3].set_position(glm::vec3(15.0f, -4.0f, 0.0f));
+
+    // ----- AI ----- //
+    m_ai_machine = new AIStateMachine();
+    m_perception = new Perception();
+    return m_ai_machine->load(ai_table_filepath);
+}
+
+void Simulation::step(unsigned char input)
+{
+    ALLOCATION_TAG(ALLOC_SIMULATION);
+
+    // ————— INPUT ————— //
+    m_player->set_movement(glm::vec3(0.0f));
+
+    m_player_jumped = false;
+    if ((input & INPUT_JUMP) && m_player->get_map_collided_bottom())
+    {
+        m_player->jump();
+        m_player_jumped = true;
+    }
+
+    if (input & INPUT_LEFT)       m_player->move_left();
+    else if (input & INPUT_RIGHT) m_player->move_right();
+
+    if (glm::length(m_player->get_movement()) > 1.0f)
+        m_player->normalise_movement();
+
+    // ————— PLAYER ————— //
+    // Serial: the player is the only entity that touches the others
+    m_player->update(FIXED_TIMESTEP, m_player, m_enemies, ENEMY_COUNT, m_map, m_current_enemy_count);
+    if (m_current_enemy_count >= m_player->get_enemy_count()) m_current_enemy_count = m_player->get_enemy_count();
+
+    // Serial pass: the bullet's fate depends on another enemy, so settle it
+    // before the per-enemy phases run in parallel
+    for (int i = 0; i < ENEMY_COUNT; i++) {
+        // deactivate bullet if shooter is dead
+        Entity *current_enemy = &m_enemies[i];
+        if (current_enemy->get_entity_type() == ENEMY && current_enemy->get_ai_type() == SHOOTER && !current_enemy->get_activation_status()) {
+            m_shooter_is_active = false;
+        }
+
+        if (current_enemy->get_entity_type() == ENEMY && current_enemy->get_ai_type() == BULLET && current_enemy->get_activation_status() && !m_shooter_is_active) {
+            current_enemy->deactivate();
+            m_current_enemy_count--;
+        }
+    }
+
+    // ————— ENEMIES ————— //
+    // Parallel phases: each enemy only writes to itself, and every phase
+    // finishes before the next one starts
+    {
+        ALLOCATION_TAG(ALLOC_AI);
+
+        // 1. Perception: distances, directions and line of sight to the player
+        m_perception->update(m_enemies, ENEMY_COUNT, m_player, m_map, m_jobs);
+
+        // 2. AI decisions for every enemy, grouped by state
+        m_ai_machine->update(m_enemies, ENEMY_COUNT, *m_perception, m_jobs);
+    }
+
+    // 3. Integration
+    auto integrate = [this](int begin, int end) {
+        for (int i = begin; i < end; i++) m_enemies[i].integrate(FIXED_TIMESTEP);
+    };
+
+    // 4. Map collision
+    auto collide = [this](int begin, int end) {
+        for (int i = begin; i < end; i++) m_enemies[i].collide_with_map(FIXED_TIMESTEP, m_map);
+    };
+
+    if (m_jobs != nullptr)
+    {
+        m_jobs->parallel_for(ENEMY_COUNT, ENEMY_JOB_GRAIN, integrate);
+        m_jobs->parallel_for(ENEMY_COUNT, ENEMY_JOB_GRAIN, collide);
+    }
+    else
+    {
+        integrate(0, ENEMY_COUNT);
+        collide(0, ENEMY_COUNT);
+    }
+
+    // ————— RESULT ————— //
+    // check for lose
+    if (!m_player->get_activation_status()) m_result = LOSE;
+
+    // check for win
+    if (m_current_enemy_count == 0) m_result = WIN;
+
+    m_step_count++;
+}
+
+// FNV-1a, fed a value at a time
+static void hash_bytes(unsigned int *hash, const void *data, size_t size)
+{
+    const unsigned char *bytes = (const unsigned char *) data;
+    for (size_t i = 0; i < size; i++)
+    {
+        *hash ^= bytes[i];
+        *hash *= 16777619u;
+    }
+}
+
+static void hash_entity(unsigned int *hash, const Entity &entity)
+{
+    glm::vec3 position = entity.get_position(),
+              velocity = entity.get_velocity(),
+              movement = entity.get_movement();
+    bool is_active   = entity.get_activation_status();
+    AIState ai_state = entity.get_ai_state();
+
+    hash_bytes(hash, &position, sizeof(position));
+    hash_bytes(hash, &velocity, sizeof(velocity));
+    hash_bytes(hash, &movement, sizeof(movement));
+    hash_bytes(hash, &is_active, sizeof(is_active));
+    hash_bytes(hash, &ai_state, sizeof(ai_state));
+}
+
+unsigned int const Simulation::checksum() const
+{
+    unsigned int hash = 2166136261u;
+
+    hash_entity(&hash, *m_player);
+    for (int i = 0; i < ENEMY_COUNT; i++) hash_entity(&hash, m_enemies[i]);
+
+    hash_bytes(&hash, &m_result, sizeof(m_result));
+    hash_bytes(&hash, &m_current_enemy_count, sizeof(m_current_enemy_count));
+    hash_bytes(&hash, &m_step_count, sizeof(m_step_count));
+    return hash;
+}
+
+glm::mat4 const Simulation::get_view_matrix() const
+{
+    float camera_x = m_player->get_position().x;
+    if (camera_x <= LEFT_EDGE)  camera_x = LEFT_EDGE;
+    if (camera_x >= RIGHT_EDGE) camera_x = RIGHT_EDGE;
+
+    return glm::translate(glm::mat4(1.0f), glm::vec3(-camera_x, 3, 0));
+}
+
+void Simulation::render(ShaderProgram *program) const
+{
+    ALLOCATION_TAG(ALLOC_RENDER);
+    m_player->render(program);
+    for (int i = 0; i < ENEMY_COUNT; i++) m_enemies[i].render(program);
+    m_map->render(program);
+}
+
+void Simulation::save_state(std::vector<unsigned char> *snapshot) const
+{
+    ALLOCATION_TAG(ALLOC_SNAPSHOTS);
+    snapshot->clear();
+    StateWriter writer(snapshot);
+
+    writer.write(SNAPSHOT_MAGIC);
+    writer.write(SNAPSHOT_VERSION);
+    writer.write(ENEMY_COUNT);
+
+    writer.write(m_result);
+    writer.write(m_shooter_is_active);
+    writer.write(m_current_enemy_count);
+    writer.write(m_step_count);
+    writer.write(m_player_jumped);
+
+    m_player->save_state(&writer);
+    for (int i = 0; i < ENEMY_COUNT; i++) m_enemies[i].save_state(&writer);
+}
+
+bool Simulation::load_state(const std::vector<unsigned char> &snapshot)
+{
+    StateReader reader(snapshot.data(), snapshot.size());
+
+    unsigned int magic = 0, version = 0;
+    int enemy_count = 0;
+    reader.read(&magic);
+    reader.read(&version);
+    reader.read(&enemy_count);
+    if (!reader.is_ok() || magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION || enemy_count != ENEMY_COUNT) return false;
+
+    reader.read(&m_result);
+    reader.read(&m_shooter_is_active);
+    reader.read(&m_current_enemy_count);
+    reader.read(&m_step_count);
+    reader.read(&m_player_jumped);
+
+    m_player->load_state(&reader);
+    for (int i = 0; i < ENEMY_COUNT; i++) m_enemies[i].load_state(&reader);
+
+    return reader.is_ok() && reader.is_at_end();
+}
@@ -0,0 +1,103 @@
+//
+//  Simulation.h
+//  04_AI
+//
+
+#pragma once
+#include "Entity.h"
+#include "Map.h"
+#include "AIStateMachine.h"
+#include "JobSystem.h"
+#include "Perception.h"
+#include "Snapshot.h"
+
+enum GameResult { NONE, WIN, LOSE };
+
+// Everything the player can do in one fixed step, packed into a byte so that a
+// whole session can be recorded and fed back in
+enum InputBits : unsigned char
+{
+    INPUT_LEFT  = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_JUMP  = 1 << 2
+};
+
+// Texture ids for the level's sprites. A headless run leaves them all at 0.
+struct SimulationTextures
+{
+    GLuint tileset = 0,
+           player  = 0,
+           vulture = 0,
+           fox     = 0,
+           hunter  = 0,
+           bullet  = 0;
+};
+
+// The game logic of the level, with no window, audio or input device behind it.
+//
+// step() advances exactly one fixed timestep from an input bitmask, and nothing
+// else feeds into it, so the same inputs always give the same run. main() drives
+// it from the keyboard; a recorded session can drive it just as well.
+class Simulation
+{
+private:
+    Map            *m_map        = nullptr;
+    Entity         *m_player     = nullptr;
+    Entity         *m_enemies    = nullptr;
+    AIStateMachine *m_ai_machine = nullptr;
+    Perception     *m_perception = nullptr;
+    JobSystem      *m_jobs       = nullptr;   // not owned; nullptr runs every phase inline
+
+    GameResult m_result = NONE;
+    bool m_shooter_is_active   = true;
+    int  m_current_enemy_count = 0;
+    int  m_step_count          = 0;
+    bool m_player_jumped       = false;
+
+public:
+    // ————— STATIC VARIABLES ————— //
+    static constexpr float FIXED_TIMESTEP = 0.0166666f;
+    static constexpr int   ENEMY_COUNT    = 4;
+    static constexpr int   LEVEL1_WIDTH   = 20;
+    static constexpr int   LEVEL1_HEIGHT  = 8;
+
+    // Enemies per job when the enemy step is split across threads
+    static constexpr int   ENEMY_JOB_GRAIN = 256;
+
+    static constexpr unsigned int SNAPSHOT_MAGIC   = 0x50414E53;  // "SNAP"
+    static constexpr unsigned int SNAPSHOT_VERSION = 1;
+
+    // ————— METHODS ————— //
+    explicit Simulation(JobSystem *jobs = nullptr);
+    ~Simulation();
+
+    // Builds the level from scratch; returns false if the AI table was missing
+    bool initialise(const char *ai_table_filepath, const SimulationTextures &textures = SimulationTextures());
+    void step(unsigned char input);
+
+    // FNV-1a over every piece of state a step can change, to tell two runs apart
+    unsigned int const checksum() const;
+
+    // Everything step() reads and writes, as a compact binary blob: a header,
+    // the level's counters, then each entity's state. The map and AI table never
+    // change during a run, so loading only works on an initialised level.
+    void save_state(std::vector<unsigned char> *snapshot) const;
+    bool load_state(const std::vector<unsigned char> &snapshot);
+
+    // ————— RENDERING ————— //
+    // Drawing only needs a current GL context, with or without a window.
+    // The camera follows the player but stays inside the level's edges.
+    glm::mat4 const get_view_matrix() const;
+    void render(ShaderProgram *program) const;
+
+    // ————— GETTERS ————— //
+    Map        *const get_map()     const { return m_map;     }
+    Entity     *const get_player()  const { return m_player;  }
+    Entity     *const get_enemies() const { return m_enemies; }
+    GameResult  const get_result()  const { return m_result;  }
+    int         const get_step_count()          const { return m_step_count; }
+    int         const get_current_enemy_count() const { return m_current_enemy_count; }
+
+    // True when the last step started a jump, so the caller can play the sound
+    bool        const get_player_jumped() const { return m_player_jumped; }
+};
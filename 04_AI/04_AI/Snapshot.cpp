@@ -0,0 +1,203 @@
+//
+//  Snapshot.cpp
+//  04_AI
+//
+
+#include "Snapshot.h"
+#include <algorithm>
+#include "Allocations.h"
+
+namespace
+{
+    // Delta encoding: alternating (zero run, literal run) pairs of varints,
+    // each literal run followed by its XORed bytes
+    void write_varint(std::vector<unsigned char> *out, size_t value)
+    {
+        while (value >= 0x80)
+        {
+            out->push_back((unsigned char) (value | 0x80));
+            value >>= 7;
+        }
+        out->push_back((unsigned char) value);
+    }
+
+    bool read_varint(const std::vector<unsigned char> &in, size_t *cursor, size_t *value)
+    {
+        *value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            if (*cursor >= in.size()) return false;
+            unsigned char byte = in[(*cursor)++];
+            *value |= (size_t) (byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return true;
+        }
+        return false;
+    }
+}
+
+SnapshotHistory::SnapshotHistory(int capacity, int keyframe_interval)
+    : m_entries(std::max(capacity, 1)), m_keyframe_interval(std::max(keyframe_interval, 1)) { }
+
+void SnapshotHistory::reserve(size_t snapshot_size)
+{
+    ALLOCATION_TAG(ALLOC_SNAPSHOTS);
+    for (Entry &entry : m_entries) entry.bytes.reserve(snapshot_size);
+    m_latest.reserve(snapshot_size);
+    m_scratch.reserve(snapshot_size);
+}
+
+bool SnapshotHistory::encode_delta(const std::vector<unsigned char> &previous, const std::vector<unsigned char> &current,
+                                   std::vector<unsigned char> *delta, size_t max_size)
+{
+    // Two varints of at most this many bytes each, per run pair
+    constexpr size_t MAX_VARINT_SIZE = (sizeof(size_t) * 8 + 6) / 7;
+
+    delta->clear();
+    if (max_size < MAX_VARINT_SIZE) return false;
+    write_varint(delta, current.size());
+
+    size_t i = 0;
+    while (i < current.size())
+    {
+        size_t zero_start = i;
+        while (i < current.size() && i < previous.size() && previous[i] == current[i]) i++;
+
+        size_t literal_start = i;
+        while (i < current.size() && (i >= previous.size() || previous[i] != current[i])) i++;
+
+        if (delta->size() + 2 * MAX_VARINT_SIZE + (i - literal_start) > max_size) return false;
+
+        write_varint(delta, literal_start - zero_start);
+        write_varint(delta, i - literal_start);
+        for (size_t k = literal_start; k < i; k++)
+            delta->push_back(current[k] ^ (k < previous.size() ? previous[k] : 0));
+    }
+    return true;
+}
+
+bool SnapshotHistory::apply_delta(const std::vector<unsigned char> &delta, std::vector<unsigned char> *snapshot)
+{
+    size_t cursor = 0, size;
+    if (!read_varint(delta, &cursor, &size)) return false;
+    snapshot->resize(size, 0);
+
+    size_t i = 0;
+    while (i < size)
+    {
+        size_t zero_run, literal_run;
+        if (!read_varint(delta, &cursor, &zero_run) || !read_varint(delta, &cursor, &literal_run)) return false;
+        if (i + zero_run + literal_run > size || cursor + literal_run > delta.size()) return false;
+
+        i += zero_run;
+        for (size_t k = 0; k < literal_run; k++) (*snapshot)[i++] ^= delta[cursor++];
+    }
+    return true;
+}
+
+void SnapshotHistory::push(int step, const std::vector<unsigned char> &snapshot)
+{
+    ALLOCATION_TAG(ALLOC_SNAPSHOTS);
+    if (m_count == (int) m_entries.size()) drop_oldest();
+
+    Entry &entry = entry_at(m_count);
+    int since_key = 0;
+    for (int i = m_count - 1; i >= 0 && !entry_at(i).is_key; i--) since_key++;
+
+    entry.step     = step;
+    entry.is_key   = m_count == 0 || since_key + 1 >= m_keyframe_interval;
+    entry.raw_size = snapshot.size();
+    if (!entry.is_key && !encode_delta(m_latest, snapshot, &entry.bytes, snapshot.size())) entry.is_key = true;
+    if (entry.is_key) entry.bytes.assign(snapshot.begin(), snapshot.end());
+
+    m_latest.assign(snapshot.begin(), snapshot.end());
+    m_raw_bytes += snapshot.size();
+    m_count++;
+}
+
+void SnapshotHistory::drop_oldest()
+{
+    Entry &oldest = entry_at(0);
+    m_raw_bytes -= oldest.raw_size;
+
+    // The next entry is a delta against the one we are dropping: promote it
+    if (m_count > 1 && !entry_at(1).is_key)
+    {
+        Entry &next = entry_at(1);
+        m_scratch.assign(oldest.bytes.begin(), oldest.bytes.end());
+        apply_delta(next.bytes, &m_scratch);
+        next.bytes.swap(m_scratch);
+        next.is_key = true;
+    }
+
+    oldest.bytes.clear();
+    oldest.step = -1;
+    m_first = (m_first + 1) % m_entries.size();
+    m_count--;
+}
+
+int const SnapshotHistory::index_of(int step) const
+{
+    // Steps increase along the ring, so binary search it
+    int low = 0, high = m_count - 1;
+    while (low <= high)
+    {
+        int middle = (low + high) / 2;
+        int middle_step = entry_at(middle).step;
+        if (middle_step == step) return middle;
+        if (middle_step < step) low = middle + 1;
+        else high = middle - 1;
+    }
+    return -1;
+}
+
+bool SnapshotHistory::get(int step, std::vector<unsigned char> *snapshot) const
+{
+    int index = index_of(step);
+    if (index < 0) return false;
+
+    int key = index;
+    while (!entry_at(key).is_key) key--;
+
+    *snapshot = entry_at(key).bytes;
+    for (int i = key + 1; i <= index; i++)
+        if (!apply_delta(entry_at(i).bytes, snapshot)) return false;
+    return true;
+}
+
+void SnapshotHistory::truncate_after(int step)
+{
+    int newest = m_count - 1;
+    while (newest >= 0 && entry_at(newest).step > step) newest--;
+    if (newest == m_count - 1) return;
+
+    if (newest >= 0) get(entry_at(newest).step, &m_latest);
+    else m_latest.clear();
+
+    for (int i = newest + 1; i < m_count; i++)
+    {
+        m_raw_bytes -= entry_at(i).raw_size;
+        entry_at(i).bytes.clear();
+        entry_at(i).step = -1;
+    }
+    m_count = newest + 1;
+}
+
+void SnapshotHistory::clear()
+{
+    for (Entry &entry : m_entries)
+    {
+        entry.bytes.clear();
+        entry.step = -1;
+    }
+    m_first = 0;
+    m_count = 0;
+    m_latest.clear();
+    m_raw_bytes = 0;
+}
+
+size_t const SnapshotHistory::get_stored_bytes() const
+{
+    size_t total = 0;
+    for (int i = 0; i < m_count; i++) total += entry_at(i).bytes.size();
+    return total;
+}
@@ -0,0 +1,130 @@
+//
+//  Snapshot.h
+//  04_AI
+//
+
+#pragma once
+#include <string.h>
+#include <type_traits>
+#include <vector>
+
+// ————— STATE STREAMS ————— //
+// Each class that has state to snapshot writes its fields in order with a
+// StateWriter and reads them back in the same order with a StateReader. Fields
+// are copied as raw bytes, with no padding between them.
+class StateWriter
+{
+private:
+    std::vector<unsigned char> *m_bytes;
+
+public:
+    explicit StateWriter(std::vector<unsigned char> *bytes) : m_bytes(bytes) { }
+
+    template <typename T>
+    void write(const T &value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be plain data");
+        const unsigned char *bytes = (const unsigned char *) &value;
+        m_bytes->insert(m_bytes->end(), bytes, bytes + sizeof(T));
+    }
+};
+
+class StateReader
+{
+private:
+    const unsigned char *m_data;
+    size_t m_size;
+    size_t m_cursor = 0;
+    bool   m_failed = false;
+
+public:
+    StateReader(const unsigned char *data, size_t size) : m_data(data), m_size(size) { }
+
+    // Leaves value alone and marks the stream failed if it has run out
+    template <typename T>
+    void read(T *value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "snapshot fields must be plain data");
+        if (m_failed || m_cursor + sizeof(T) > m_size)
+        {
+            m_failed = true;
+            return;
+        }
+        memcpy(value, m_data + m_cursor, sizeof(T));
+        m_cursor += sizeof(T);
+    }
+
+    bool const is_ok()     const { return !m_failed; }
+    bool const is_at_end() const { return m_cursor == m_size; }
+};
+
+// ————— SNAPSHOT HISTORY ————— //
+// A ring buffer of the last few hundred per-step snapshots of a Simulation.
+//
+// Most snapshots are stored as a delta against the one before: the two are
+// XORed, which leaves zeros wherever nothing changed, and the runs of zeros are
+// run-length encoded. Every keyframe_interval-th snapshot is stored whole, so
+// getting any step back costs at most that many deltas. When the oldest
+// keyframe falls out of the ring, the delta after it is promoted to a keyframe.
+// A delta that would come out bigger than the snapshot is stored whole instead,
+// so no entry ever needs more than the snapshot's size; after reserve() the
+// ring reuses its buffers and pushing never allocates.
+class SnapshotHistory
+{
+private:
+    struct Entry
+    {
+        int    step     = -1;
+        bool   is_key   = false;
+        size_t raw_size = 0;            // the snapshot's size before encoding
+        std::vector<unsigned char> bytes;
+    };
+
+    std::vector<Entry> m_entries;       // ring
+    int m_first = 0,                    // oldest entry
+        m_count = 0;
+    int m_keyframe_interval;
+
+    std::vector<unsigned char> m_latest;  // the newest snapshot, uncompressed
+    std::vector<unsigned char> m_scratch; // where drop_oldest rebuilds a promoted keyframe
+    size_t m_raw_bytes = 0;               // what the retained snapshots would take whole
+
+    Entry       &entry_at(int index)       { return m_entries[(m_first + index) % m_entries.size()]; }
+    const Entry &entry_at(int index) const { return m_entries[(m_first + index) % m_entries.size()]; }
+    int const index_of(int step) const;
+    void drop_oldest();
+
+    // False, with delta left partly written, if it would take more than max_size bytes
+    static bool encode_delta(const std::vector<unsigned char> &previous, const std::vector<unsigned char> &current,
+                             std::vector<unsigned char> *delta, size_t max_size);
+    static bool apply_delta(const std::vector<unsigned char> &delta, std::vector<unsigned char> *snapshot);
+
+public:
+    static constexpr int DEFAULT_CAPACITY          = 600;   // ten seconds of fixed steps
+    static constexpr int DEFAULT_KEYFRAME_INTERVAL = 60;
+
+    explicit SnapshotHistory(int capacity = DEFAULT_CAPACITY, int keyframe_interval = DEFAULT_KEYFRAME_INTERVAL);
+
+    // Sizes every buffer for snapshots of snapshot_size bytes up front
+    void reserve(size_t snapshot_size);
+
+    // Steps must be pushed in increasing order
+    void push(int step, const std::vector<unsigned char> &snapshot);
+
+    // Rebuilds the snapshot for step; false if it is no longer (or not yet) held
+    bool get(int step, std::vector<unsigned char> *snapshot) const;
+
+    // Forgets everything after step, e.g. before playing on from a rewind
+    void truncate_after(int step);
+    void clear();
+
+    // ————— GETTERS ————— //
+    int    const get_count()       const { return m_count; }
+    int    const get_capacity()    const { return (int) m_entries.size(); }
+    int    const get_oldest_step() const { return m_count > 0 ? entry_at(0).step : -1; }
+    int    const get_newest_step() const { return m_count > 0 ? entry_at(m_count - 1).step : -1; }
+
+    // Bytes held for the retained snapshots, against what they would take whole
+    size_t const get_stored_bytes() const;
+    size_t const get_raw_bytes()    const { return m_raw_bytes; }
+};
@@ -0,0 +1,30 @@
+//
+//  Span.h
+//  04_AI
+//
+
+#pragma once
+#include <cstddef>
+
+// A view of size contiguous Ts owned by something else: std::span's shape,
+// for builds that are not on C++20. Valid for as long as what it points into.
+template <typename T>
+class Span
+{
+private:
+    T *m_data = nullptr;
+    size_t m_size = 0;
+
+public:
+    Span() = default;
+    Span(T *data, size_t size) : m_data(data), m_size(size) { }
+
+    T *data()     const { return m_data; }
+    size_t size() const { return m_size; }
+    bool empty()  const { return m_size == 0; }
+
+    T *begin() const { return m_data; }
+    T *end()   const { return m_data + m_size; }
+
+    T &operator[](size_t index) const { return m_data[index]; }
+};
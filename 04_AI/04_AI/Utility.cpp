@@ -13,10 +13,17 @@
 #define FONTBANK_SIZE      16
 
 #include "Utility.h"
+#include <algorithm>
+#include <cstring>
 #include <SDL_image.h>
 #include "stb_image.h"
+#include "Profiler.h"
+#include "GL.h"
+#include "Allocations.h"
 
 GLuint Utility::load_texture(const char* filepath) {
+    PROFILE_ZONE("Utility::load_texture");
+    ALLOCATION_TAG(ALLOC_ASSETS);
     int width, height, number_of_components;
     unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
     
@@ -27,31 +34,34 @@ GLuint Utility::load_texture(const char* filepath) {
     }
     
     GLuint texture_id;
-    glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image);
+    g_gl.gen_textures(NUMBER_OF_TEXTURES, &texture_id);
+    g_gl.bind_texture(GL_TEXTURE_2D, texture_id);
+    g_gl.tex_image_2d(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image);
     
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    g_gl.tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    g_gl.tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
     
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    g_gl.tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    g_gl.tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     
     stbi_image_free(image);
     
     return texture_id;
 }
 
-void Utility::draw_text(ShaderProgram *program, GLuint font_texture_id, std::string text, float screen_size, float spacing, glm::vec3 position)
+void Utility::build_text_quads(const char *text, float screen_size, float spacing,
+                               FrameVector<float> *vertices, FrameVector<float> *texture_coordinates)
 {
     float width = 1.0f / FONTBANK_SIZE;
     float height = 1.0f / FONTBANK_SIZE;
+    size_t length = strlen(text);
 
+    // Sized up front and written in place: inserting element by element is
+    // much slower with an allocator other than std::allocator
+    vertices->resize(length * 12);
+    texture_coordinates->resize(length * 12);
     
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
-    
-    for (int i = 0; i < text.size(); i++) {
+    for (size_t i = 0; i < length; i++) {
         // 1. Get their index in the spritesheet, as well as their offset (i.e. their position
         //    relative to the whole sentence)
         int spritesheet_index = (int) text[i];  // ascii value of character
@@ -61,41 +71,53 @@ void Utility::draw_text(ShaderProgram *program, GLuint font_texture_id, std::str
         float u_coordinate = (float) (spritesheet_index % FONTBANK_SIZE) / FONTBANK_SIZE;
         float v_coordinate = (float) (spritesheet_index / FONTBANK_SIZE) / FONTBANK_SIZE;
 
-        // 3. Inset the current pair in both vectors
-        vertices.insert(vertices.end(), {
+        // 3. Write the current pair into both vectors
+        const float quad[] = {
             offset + (-0.5f * screen_size), 0.5f * screen_size,
             offset + (-0.5f * screen_size), -0.5f * screen_size,
             offset + (0.5f * screen_size), 0.5f * screen_size,
             offset + (0.5f * screen_size), -0.5f * screen_size,
             offset + (0.5f * screen_size), 0.5f * screen_size,
             offset + (-0.5f * screen_size), -0.5f * screen_size,
-        });
+        };
 
-        texture_coordinates.insert(texture_coordinates.end(), {
+        const float quad_coordinates[] = {
             u_coordinate, v_coordinate,
             u_coordinate, v_coordinate + height,
             u_coordinate + width, v_coordinate,
             u_coordinate + width, v_coordinate + height,
             u_coordinate + width, v_coordinate,
             u_coordinate, v_coordinate + height,
-        });
+        };
+
+        std::copy(quad, quad + 12, vertices->data() + i * 12);
+        std::copy(quad_coordinates, quad_coordinates + 12, texture_coordinates->data() + i * 12);
     }
+}
+
+void Utility::draw_text(ShaderProgram *program, GLuint font_texture_id, const char *text, float screen_size, float spacing, glm::vec3 position)
+{
+    PROFILE_ZONE("Utility::draw_text");
+    ALLOCATION_TAG(ALLOC_TEXT);
+    FrameVector<float> vertices;
+    FrameVector<float> texture_coordinates;
+    build_text_quads(text, screen_size, spacing, &vertices, &texture_coordinates);
 
     // 4. And render all of them using the pairs
     glm::mat4 model_matrix = glm::mat4(1.0f);
     model_matrix = glm::translate(model_matrix, position);
     
     program->set_model_matrix(model_matrix);
-    glUseProgram(program->get_program_id());
+    g_gl.use_program(program->get_program_id());
     
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices.data());
-    glEnableVertexAttribArray(program->get_position_attribute());
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices.data());
+    g_gl.enable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, texture_coordinates.data());
+    g_gl.enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
     
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int) (text.size() * 6));
+    g_gl.bind_texture(GL_TEXTURE_2D, font_texture_id);
+    g_gl.draw_arrays(GL_TRIANGLES, 0, (int) (vertices.size() / 2));
     
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_position_attribute());
+    g_gl.disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 }
@@ -13,16 +13,23 @@
 #endif
 
 #define GL_GLEXT_PROTOTYPES 1
+#include <string>
 #include <vector>
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "FrameArena.h"
 
 class Utility {
 public:
     // ————— METHODS ————— //
     static GLuint load_texture(const char* filepath);
-    static void draw_text(ShaderProgram *program, GLuint font_texture_id, std::string text, float screen_size, float spacing, glm::vec3 position);
+    // The two triangles per character that draw_text sends to GL, with the
+    // matching font sheet coordinates; replaces the vectors' contents
+    static void build_text_quads(const char *text, float screen_size, float spacing,
+                                 FrameVector<float> *vertices, FrameVector<float> *texture_coordinates);
+    // Builds the quads in the frame arena, so drawing text never touches the heap
+    static void draw_text(ShaderProgram *program, GLuint font_texture_id, const char *text, float screen_size, float spacing, glm::vec3 position);
 };
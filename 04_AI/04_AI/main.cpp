@@ -12,11 +12,7 @@
 //#define STB_IMAGE_IMPLEMENTATION
 #define LOG(argument) std::cout << argument << '\n'
 #define GL_GLEXT_PROTOTYPES 1
-#define FIXED_TIMESTEP 0.0166666f
 #define PLATFORM_COUNT 11
-#define ENEMY_COUNT 4
-#define LEVEL1_WIDTH 20
-#define LEVEL1_HEIGHT 8
 
 
 #ifdef _WINDOWS
@@ -32,25 +28,38 @@
 #include "stb_image.h"
 #include "cmath"
 #include <ctime>
+#include <string.h>
 #include <vector>
 #include "Entity.h"
 #include "Map.h"
 #include "Utility.h"
+#include "JobSystem.h"
+#include "Simulation.h"
+#include "InputRecording.h"
+#include "Snapshot.h"
+#include "Profiler.h"
+#include "FrameStats.h"
+#include "PerfOverlay.h"
+#include "Allocations.h"
+#include "FrameArena.h"
 
 // ----- STRUCTS AND ENUMS ----- //
 struct GameState
 {
-    Map *map;
-    Entity* player;
-//    Entity* platforms;
-    Entity* enemies;
+    Simulation* simulation;
+    JobSystem* jobs;
+    SnapshotHistory* history;
+    PerfOverlay* overlay;
 
     Mix_Music* bgm;
     Mix_Chunk* jump_sfx;
 };
 
 enum AppStatus { RUNNING, TERMINATED };
-enum GameResult { NONE, WIN, LOSE };
+
+// Live plays from the keyboard; --record also writes each step's input to a
+// file, and --replay plays one of those files back instead of the keyboard
+enum InputMode { LIVE, RECORDING, REPLAYING };
 
 // ----- CONSTANTS ----- //
 constexpr int WINDOW_WIDTH = 640,
@@ -81,6 +90,15 @@ HUNTERSHEET_FILEPATH[] = "assets/hunter.png",
 BULLETSHEET_FILEPATH[] = "assets/bullet.png",
 FONTSHEET_FILEPATH[] = "assets/font1.png";
 
+constexpr char AI_TABLE_FILEPATH[] = "assets/ai_machine.txt";
+
+// How far back R takes the game
+constexpr int REWIND_STEPS = 120;
+
+// Frames before the loop counts as warmed up: by then the snapshot ring and
+// every buffer reused from frame to frame have grown to their working size
+constexpr int STEADY_STATE_FRAME = 300;
+
 constexpr char BGM_FILEPATH[] = "assets/theSnowQueen.mp3",
 SFX_FILEPATH[] = "assets/snowWalk.mp3";
 
@@ -88,7 +106,6 @@ SFX_FILEPATH[] = "assets/snowWalk.mp3";
 
 // ----- VARIABLES ----- //
 GameState g_game_state;
-GameResult g_game_result = NONE;
 
 SDL_Window* g_display_window;
 bool g_game_is_running = true;
@@ -101,36 +118,43 @@ float g_accumulator = 0.0f;
 
 AppStatus g_app_status = RUNNING;
 
-unsigned int LEVEL_1_DATA[] = {
-    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
-    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
-    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
-    19, 0, 0, 0, 14, 15, 16, 0, 0, 0, 0, 14, 16, 0, 0, 0, 0, 0, 0, 19,
-    19, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 19,
-    19, 0, 0, 0, 0, 0, 0, 1, 3, 0, 0, 0, 0, 0, 0, 1, 3, 0, 0, 19,
-    19, 2, 2, 2, 2, 2, 7, 8, 10, 11, 2, 2, 2, 2, 7, 8, 10, 11, 2, 19,
-    19, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 19
-    
-};
-
 //GLuint load_texture(const char* filepath);
 GLuint g_font_texture_id;
 
-bool g_shooter_is_active = true;
-int g_current_enemy_count = ENEMY_COUNT;
+// Input is sampled per frame but consumed per fixed step: held keys apply to
+// every step, and a jump press is held over until a step picks it up
+unsigned char g_held_input = 0;
+bool g_jump_pressed = false;
+
+InputMode g_input_mode = LIVE;
+const char* g_recording_filepath = nullptr;
+InputRecording g_recording;
+
+std::vector<unsigned char> g_snapshot;
+bool g_rewind_pressed = false;
+
+// --profile writes a Chrome trace of the session here on exit
+const char* g_profile_filepath = nullptr;
+
+// --check-allocations flags every allocation once the loop is warmed up
+bool g_is_checking_allocations = false;
 
 float g_message_x = 0.0f,
 g_message_y = 0.0f;
 
 void initialise();
 void process_input();
+unsigned char next_step_input();
+void rewind();
 void update();
 void render();
+void end_frame();
 void shutdown();
 
 // ----- GENERAL FUNCTIONS ----- //
 void initialise()
 {
+    PROFILE_ZONE("initialise");
     // ----- GENERAL STUFF ----- //
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
     g_display_window = SDL_CreateWindow("Hello, AI!",
@@ -144,7 +168,8 @@ void initialise()
     if (context == nullptr)
     {
         LOG("ERROR: Could not create OpenGL context.\n");
-        shutdown();
+        g_app_status = TERMINATED;
+        return;
     }
 
 #ifdef _WINDOWS
@@ -165,85 +190,33 @@ void initialise()
 
     glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
     
-    // ————— MAP SET-UP ————— //
-    GLuint map_texture_id = Utility::load_texture(TILESET_FILEPATH);
-    g_game_state.map = new Map(LEVEL1_WIDTH, LEVEL1_HEIGHT, LEVEL_1_DATA, map_texture_id, 1.0f, 5, 4);
-
-    // ------ PLAYER ------//
-    GLuint player_texture_id = Utility::load_texture(PLAYERSHEET_FILEPATH);
-
-    int player_walking_animation[4][4] =
-    {
-    { 4, 5, 6, 7 },  // for player to move to the left,
-    { 12, 13, 14, 15 }, // for player to move to the right,
-    { 0, 1, 2, 3 }, // for player to move upwards,
-    { 8, 9, 10, 11 }   // for player to move downwards
-    };
-//    int player_walking_animation[4][4] =
-//    {
-//        { 1, 5, 9, 13 },  // for George to move to the left,
-//        { 3, 7, 11, 15 }, // for George to move to the right,
-//        { 2, 6, 10, 14 }, // for George to move upwards,
-//        { 0, 4, 8, 12 }   // for George to move downwards
-//    };
-
-
-    glm::vec3 gravity = glm::vec3(0.0f, -4.905f, 0.0f);
-
-    g_game_state.player = new Entity(
-        player_texture_id,         // texture id
-        3.0f,                      // speed
-        gravity,              // acceleration
-        3.0f,                      // jumping power
-        player_walking_animation,  // animation index sets
-        0.0f,                      // animation time
-        4,                         // animation frame amount
-        0,                         // current animation index
-        4,                         // animation column amount
-        4,                         // animation row amount
-        0.5f,                      // width
-        0.5f,                       // height
-        PLAYER,
-        NOTYPE,
-        NOSTATE
-    );
-    g_game_state.player->set_position(glm::vec3(7.0f, -4.0f, 0.0f));
-    // Jumping
-    g_game_state.player->set_jumping_power(4.5f);
-    g_game_state.player->set_enemy_count(ENEMY_COUNT);
-
-    g_game_state.enemies = new Entity[ENEMY_COUNT];
-    GLuint vulture_texture_id = Utility::load_texture(VULTURESHEET_FILEPATH);
-    GLuint fox_texture_id = Utility::load_texture(FOXSHEET_FILEPATH);
-    GLuint hunter_texture_id = Utility::load_texture(HUNTERSHEET_FILEPATH);
-    GLuint bullet_texture_id = Utility::load_texture(BULLETSHEET_FILEPATH);
-    
-    int enemy_animation[4][4] =
+    // ————— LEVEL ————— //
+    SimulationTextures textures;
+    textures.tileset = Utility::load_texture(TILESET_FILEPATH);
+    textures.player  = Utility::load_texture(PLAYERSHEET_FILEPATH);
+    textures.vulture = Utility::load_texture(VULTURESHEET_FILEPATH);
+    textures.fox     = Utility::load_texture(FOXSHEET_FILEPATH);
+    textures.hunter  = Utility::load_texture(HUNTERSHEET_FILEPATH);
+    textures.bullet  = Utility::load_texture(BULLETSHEET_FILEPATH);
+
+    g_game_state.jobs = new JobSystem();
+    g_game_state.simulation = new Simulation(g_game_state.jobs);
+    if (!g_game_state.simulation->initialise(AI_TABLE_FILEPATH, textures))
     {
-    { 0, 1, 2, 3 },     // fly left,
-    { 4, 5, 6, 7 }, // fly right,
-    { 8, 9, 10, 11 },     // die left,
-    { 12, 13, 14, 15 }    // die right
-    };
-
-    // ----- VULTURE ----- //
-
-    g_game_state.enemies[0] = Entity(vulture_texture_id, -1.0f, glm::vec3(0.0f), 0.0f, enemy_animation, 0.0f, 4, 0, 4, 4, 1.0f, 1.0f, ENEMY, FLYER, IDLE);
-    g_game_state.enemies[0].set_position(glm::vec3(8.0f, -0.5f, 0.0f));
-
-    // ----- FOX ----- //
+        LOG("Enemies will use their built-in behaviour.");
+    }
 
-    g_game_state.enemies[1] = Entity(fox_texture_id, 1.0f, gravity, 0.0f, enemy_animation, 0.0f, 4, 0, 4, 4, 1.5f, 1.5f, ENEMY, GUARD, IDLE);
-    g_game_state.enemies[1].set_position(glm::vec3(2.0f, -5.0f, 0.0f));
-
-    // ----- HUNTER ----- //
-    g_game_state.enemies[2] = Entity(hunter_texture_id, 1.0f, 1.0f, 1.0f, ENEMY, SHOOTER, IDLE);
-    g_game_state.enemies[2].set_position(glm::vec3(15.5f, -4.0f, 0.0f));
-    
-    // ----- BULLET ----- //
-    g_game_state.enemies[3] = Entity(bullet_texture_id, 2.0f, 0.3f, 0.3f, ENEMY, BULLET, IDLE);
-    g_game_state.enemies[3].set_position(glm::vec3(15.0f, -4.0f, 0.0f));
+    g_game_state.history = new SnapshotHistory();
+    g_game_state.simulation->save_state(&g_snapshot);
+    g_game_state.history->reserve(g_snapshot.size());
+    g_game_state.history->push(g_game_state.simulation->get_step_count(), g_snapshot);
 
+    // ----- INPUT RECORDING ----- //
+    if (g_input_mode == REPLAYING && !g_recording.load(g_recording_filepath))
+    {
+        LOG("Playing live instead.");
+        g_input_mode = LIVE;
+    }
 
     // ----- AUDIO STUFF ----- //
     Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096);
@@ -256,6 +229,7 @@ void initialise()
     
     // ----- FONT -----//
     g_font_texture_id = Utility::load_texture(FONTSHEET_FILEPATH);
+    g_game_state.overlay = new PerfOverlay(g_font_texture_id);
 
     // ----- GENERAL STUFF ----- //
     glEnable(GL_BLEND);
@@ -264,8 +238,7 @@ void initialise()
 
 void process_input()
 {
-    g_game_state.player->set_movement(glm::vec3(0.0f));
-
+    PROFILE_ZONE("process_input");
     SDL_Event event;
     while (SDL_PollEvent(&event))
     {
@@ -284,12 +257,18 @@ void process_input()
                 break;
 
             case SDLK_SPACE:
-                // Jump
-                if (g_game_state.player->get_map_collided_bottom())
-                {
-                    g_game_state.player->jump();
-                    Mix_PlayChannel(-1, g_game_state.jump_sfx, 0);
-                }
+                // Jump on the next step
+                g_jump_pressed = true;
+                break;
+
+            case SDLK_r:
+                // Go back a couple of seconds and play on from there
+                g_rewind_pressed = true;
+                break;
+
+            case SDLK_F3:
+                // Frame time and renderer counters
+                g_game_state.overlay->toggle();
                 break;
 
             default:
@@ -303,114 +282,196 @@ void process_input()
 
     const Uint8* key_state = SDL_GetKeyboardState(NULL);
 
-    if (key_state[SDL_SCANCODE_LEFT])       g_game_state.player->move_left();
-    else if (key_state[SDL_SCANCODE_RIGHT]) g_game_state.player->move_right();
+    g_held_input = 0;
+    if (key_state[SDL_SCANCODE_LEFT])       g_held_input |= INPUT_LEFT;
+    else if (key_state[SDL_SCANCODE_RIGHT]) g_held_input |= INPUT_RIGHT;
+}
+
+// The input for the next fixed step, from the keyboard or the recording
+unsigned char next_step_input()
+{
+    Simulation *simulation = g_game_state.simulation;
+
+    if (g_input_mode == REPLAYING)
+    {
+        int step = simulation->get_step_count();
+        if (step < g_recording.get_step_count()) return g_recording.get_input(step);
+
+        // Out of recording: the session is over
+        g_app_status = TERMINATED;
+        return 0;
+    }
+
+    unsigned char input = g_held_input;
+    if (g_jump_pressed) input |= INPUT_JUMP;
+    g_jump_pressed = false;
+
+    if (g_input_mode == RECORDING) g_recording.record(input);
+    return input;
+}
+
+void rewind()
+{
+    Simulation *simulation = g_game_state.simulation;
+    SnapshotHistory *history = g_game_state.history;
+
+    int target = simulation->get_step_count() - REWIND_STEPS;
+    if (target < history->get_oldest_step()) target = history->get_oldest_step();
+
+    if (!history->get(target, &g_snapshot) || !simulation->load_state(g_snapshot)) return;
+
+    // Play on from here: what came after is a branch we have left behind
+    history->truncate_after(target);
+    if (g_input_mode == RECORDING) g_recording.truncate(target);
+    g_jump_pressed = false;
 
-    if (glm::length(g_game_state.player->get_movement()) > 1.0f)
-        g_game_state.player->normalise_movement();
+    // A finished game stops the clock, so restart it rather than catch up
+    g_previous_ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
+    g_accumulator = 0.0f;
 }
 
 void update()
 {
-    if (g_game_result == NONE) {
+    PROFILE_ZONE("update");
+    Simulation *simulation = g_game_state.simulation;
+
+    if (g_rewind_pressed)
+    {
+        g_rewind_pressed = false;
+        rewind();
+    }
+
+    if (simulation->get_result() == NONE) {
         float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
         float delta_time = ticks - g_previous_ticks;
         g_previous_ticks = ticks;
 
         delta_time += g_accumulator;
 
-        if (delta_time < FIXED_TIMESTEP)
+        if (delta_time < Simulation::FIXED_TIMESTEP)
         {
             g_accumulator = delta_time;
             return;
         }
 
-        while (delta_time >= FIXED_TIMESTEP)
+        while (delta_time >= Simulation::FIXED_TIMESTEP && simulation->get_result() == NONE && g_app_status == RUNNING)
         {
-            g_game_state.player->update(FIXED_TIMESTEP, g_game_state.player, g_game_state.enemies, ENEMY_COUNT, g_game_state.map, g_current_enemy_count);
-            if (g_current_enemy_count >= g_game_state.player->get_enemy_count()) g_current_enemy_count = g_game_state.player->get_enemy_count();
-
-            for (int i = 0; i < ENEMY_COUNT; i++) {
-                // deactivate bullet if shooter is dead
-                Entity *current_enemy = &g_game_state.enemies[i];
-                if (current_enemy->get_entity_type() == ENEMY && current_enemy->get_ai_type() == SHOOTER && !current_enemy->get_activation_status()) {
-                    g_shooter_is_active = false;
-                }
-                
-                if (current_enemy->get_entity_type() == ENEMY && current_enemy->get_ai_type() == BULLET && current_enemy->get_activation_status() && !g_shooter_is_active) {
-                    current_enemy->deactivate();
-                    g_current_enemy_count--;
-                }
-                // normal update for enemies
-                current_enemy->update(FIXED_TIMESTEP,
-                    g_game_state.player,
-                    NULL, NULL,
-                    g_game_state.map, 0);
-            }
-            
-            // check for lose
-            if (!g_game_state.player->get_activation_status()) g_game_result = LOSE;
-            
-            // check for win
-            if (g_current_enemy_count == 0) g_game_result = WIN;
+            unsigned char input = next_step_input();
+            if (g_app_status != RUNNING) break;
+
+            PROFILE_ZONE("fixed step");
+            simulation->step(input);
+            FrameStats::count_fixed_step();
+            if (simulation->get_player_jumped()) Mix_PlayChannel(-1, g_game_state.jump_sfx, 0);
 
+            simulation->save_state(&g_snapshot);
+            g_game_state.history->push(simulation->get_step_count(), g_snapshot);
 
-            delta_time -= FIXED_TIMESTEP;
+            delta_time -= Simulation::FIXED_TIMESTEP;
         }
 
         g_accumulator = delta_time;
         
         // Prevent the camera from showing anything outside of the "edge" of the level
-        g_view_matrix = glm::mat4(1.0f);
-        
-        if (g_game_state.player->get_position().x > LEFT_EDGE && g_game_state.player->get_position().x < RIGHT_EDGE) {
-            g_view_matrix = glm::translate(g_view_matrix, glm::vec3(-g_game_state.player->get_position().x, 3, 0));
-        } else if (g_game_state.player->get_position().x <= LEFT_EDGE){
-            g_view_matrix = glm::translate(g_view_matrix, glm::vec3(-LEFT_EDGE, 3, 0));
-        } else {
-            g_view_matrix = glm::translate(g_view_matrix, glm::vec3(-RIGHT_EDGE, 3, 0));
-        }
+        g_view_matrix = simulation->get_view_matrix();
     }
 
 }
 
 void render()
 {
+    PROFILE_ZONE("render");
+    ALLOCATION_TAG(ALLOC_RENDER);
+    Simulation *simulation = g_game_state.simulation;
+    Entity *player = simulation->get_player();
+
     g_shader_program.set_view_matrix(g_view_matrix);
 
     glClear(GL_COLOR_BUFFER_BIT);
 
-    if (g_game_result == WIN) {
-        g_message_x = g_game_state.player->get_position().x - 2.0f;
+    if (simulation->get_result() == WIN) {
+        g_message_x = player->get_position().x - 2.0f;
         if (g_message_x <= LEFT_EDGE) g_message_x = LEFT_EDGE;
         Utility::draw_text(&g_shader_program, g_font_texture_id, "You Won!", 0.5f, -0.05f,
             glm::vec3(g_message_x, g_message_y, 0.0f));
     }
-    else if (g_game_result == LOSE) {
-        g_message_x = g_game_state.player->get_position().x - 2.0f;
+    else if (simulation->get_result() == LOSE) {
+        g_message_x = player->get_position().x - 2.0f;
         if (g_message_x <= LEFT_EDGE) g_message_x = LEFT_EDGE;
         Utility::draw_text(&g_shader_program, g_font_texture_id, "You Lost!", 0.5f, -0.05f,
             glm::vec3(g_message_x, g_message_y,  0.0f));
 
     }
 
-    g_game_state.player->render(&g_shader_program);
+    simulation->render(&g_shader_program);
 
-    for (int i = 0; i < ENEMY_COUNT; i++)
-        g_game_state.enemies[i].render(&g_shader_program);
-    
-    g_game_state.map->render(&g_shader_program);
+    g_game_state.overlay->render(&g_shader_program, g_view_matrix);
+
+    // GL has copied every client-side array by the time its draw returns
+    FrameArena::frame().reset();
 
+    PROFILE_ZONE("swap");
     SDL_GL_SwapWindow(g_display_window);
 }
 
+// Hands the frame's counters to the overlay, to be drawn next frame
+void end_frame()
+{
+    Simulation *simulation = g_game_state.simulation;
+
+    int active_entity_count = simulation->get_player()->get_activation_status() ? 1 : 0;
+    for (int i = 0; i < Simulation::ENEMY_COUNT; i++)
+        if (simulation->get_enemies()[i].get_activation_status()) active_entity_count++;
+
+    g_game_state.overlay->set_entity_counts(active_entity_count, Simulation::ENEMY_COUNT + 1);
+    g_game_state.overlay->push_frame(FrameStats::end_frame());
+}
+
 void shutdown()
 {
+    Allocations::set_steady_state(false);
     SDL_Quit();
 
-    delete[] g_game_state.enemies;
-    delete    g_game_state.player;
-    delete    g_game_state.map;
+    // A failed initialise() stops before the simulation and history exist
+    Simulation *simulation = g_game_state.simulation;
+    if (simulation != nullptr && g_input_mode == RECORDING)
+    {
+        g_recording.set_final_checksum(simulation->checksum());
+        if (g_recording.save(g_recording_filepath))
+            LOG("Recorded " << g_recording.get_step_count() << " steps to " << g_recording_filepath << ".");
+    }
+    else if (simulation != nullptr && g_input_mode == REPLAYING)
+    {
+        // Only a replay that ran to the end can be held to the recorded checksum
+        bool is_complete = simulation->get_step_count() == g_recording.get_step_count();
+        if (is_complete && simulation->checksum() == g_recording.get_final_checksum())
+            LOG("Replay matched the recording.");
+        else if (is_complete)
+            LOG("Replay DIVERGED from the recording.");
+    }
+
+    if (g_profile_filepath)
+    {
+        if (Profiler::write_chrome_trace(g_profile_filepath))
+            LOG("Profiled " << Profiler::get_event_count() << " zones to " << g_profile_filepath
+                << " (" << Profiler::get_dropped_count() << " dropped).");
+        else
+            LOG("Could not write the profile to " << g_profile_filepath << ".");
+    }
+
+    if (g_is_checking_allocations)
+        LOG("Steady-state allocations: " << Allocations::get_violation_count() << ".");
+
+    SnapshotHistory *history = g_game_state.history;
+    if (history != nullptr && history->get_count() > 0)
+        LOG("Snapshots: " << history->get_count() << " held, " << history->get_stored_bytes() << " bytes ("
+            << history->get_stored_bytes() / history->get_count() << " per snapshot, "
+            << history->get_raw_bytes() / history->get_count() << " uncompressed).");
+
+    delete    g_game_state.overlay;
+    delete    g_game_state.history;
+    delete    g_game_state.simulation;
+    delete    g_game_state.jobs;
     Mix_FreeChunk(g_game_state.jump_sfx);
     Mix_FreeMusic(g_game_state.bgm);
 }
@@ -418,13 +479,57 @@ void shutdown()
 // ----- GAME LOOP ----- //
 int main(int argc, char* argv[])
 {
+    // 04_AI [--record file | --replay file] [--profile file] [--check-allocations]
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--check-allocations") == 0)
+        {
+            g_is_checking_allocations = true;
+            continue;
+        }
+        if (i + 1 >= argc) break;
+
+        if (strcmp(argv[i], "--profile") == 0)
+        {
+            g_profile_filepath = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--record") == 0)      g_input_mode = RECORDING;
+        else if (strcmp(argv[i], "--replay") == 0) g_input_mode = REPLAYING;
+        else continue;
+        g_recording_filepath = argv[++i];
+    }
+
+    if (g_profile_filepath)
+    {
+        Profiler::set_thread_name("main");
+        Profiler::set_enabled(true);
+    }
+
+    // Asserts on the first one where asserts are compiled in; a release build
+    // counts them and prints the first few instead
+    if (g_is_checking_allocations)
+    {
+#ifdef NDEBUG
+        Allocations::set_check(ALLOCATION_CHECK_REPORT);
+#else
+        Allocations::set_check(ALLOCATION_CHECK_ASSERT);
+#endif
+    }
+
     initialise();
+    FrameStats::end_frame();
 
-    while (g_app_status == RUNNING)
+    for (int frame = 0; g_app_status == RUNNING; frame++)
     {
+        if (frame == STEADY_STATE_FRAME) Allocations::set_steady_state(true);
+
+        PROFILE_ZONE("frame");
         process_input();
         update();
         render();
+        end_frame();
     }
 
     shutdown();
@@ -0,0 +1,153 @@
+//
+//  crowd_bench.cpp
+//  04_AI
+//
+//  The level only has four enemies, too few for the job system to ever split
+//  a phase. This fills the level with copies of them instead (1k to 50k by
+//  default), runs the enemy phases of Simulation::step (perception, AI,
+//  integration and map collision) on one thread and then on the JobSystem,
+//  and checks that both runs end on the same checksum.
+//
+//  Usage: crowd_bench [steps] [threads] [ai_table]
+//  Run from 04_AI/04_AI so that assets/ resolves.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "AIStateMachine.h"
+#include "JobSystem.h"
+#include "Perception.h"
+#include "Simulation.h"
+
+constexpr char DEFAULT_AI_TABLE[] = "assets/ai_machine.txt";
+constexpr int  DEFAULT_STEPS      = 120;
+constexpr int  CROWD_SIZES[]      = { 1000, 2000, 5000, 10000, 20000, 50000 };
+
+// The level's own enemies, cycled through and scattered over the map with a
+// fixed seed, so every run starts from the same crowd
+std::vector<Entity> make_crowd(const Simulation &simulation, int count)
+{
+    const Map *map = simulation.get_map();
+    float width  = map->get_right_bound() - map->get_left_bound(),
+          height = map->get_top_bound() - map->get_bottom_bound();
+
+    std::vector<Entity> crowd(count);
+    unsigned int seed = 12345u;
+    for (int i = 0; i < count; i++)
+    {
+        crowd[i] = simulation.get_enemies()[i % Simulation::ENEMY_COUNT];
+
+        seed = seed * 1664525u + 1013904223u;
+        float x = map->get_left_bound() + width * (float) (seed >> 8) / (float) (1u << 24);
+        seed = seed * 1664525u + 1013904223u;
+        float y = map->get_top_bound() - height * (float) (seed >> 8) / (float) (1u << 24);
+        crowd[i].set_position(glm::vec3(x, y, 0.0f));
+    }
+    return crowd;
+}
+
+// FNV-1a over what the enemy phases write
+unsigned int const crowd_checksum(const std::vector<Entity> &crowd)
+{
+    unsigned int hash = 2166136261u;
+    for (const Entity &agent : crowd)
+    {
+        glm::vec3 position = agent.get_position(),
+                  velocity = agent.get_velocity();
+        AIState ai_state   = agent.get_ai_state();
+
+        const unsigned char *fields[] = { (const unsigned char *) &position, (const unsigned char *) &velocity,
+                                          (const unsigned char *) &ai_state };
+        size_t sizes[] = { sizeof(position), sizeof(velocity), sizeof(ai_state) };
+        for (int f = 0; f < 3; f++)
+        {
+            for (size_t i = 0; i < sizes[f]; i++)
+            {
+                hash ^= fields[f][i];
+                hash *= 16777619u;
+            }
+        }
+    }
+    return hash;
+}
+
+// Runs steps of the enemy phases over crowd and returns milliseconds per step
+double run(const Simulation &simulation, const char *ai_table, std::vector<Entity> *crowd, int steps, JobSystem *jobs)
+{
+    AIStateMachine ai_machine;
+    Perception perception;
+    ai_machine.load(ai_table);
+
+    Entity *agents = crowd->data();
+    int agent_count = (int) crowd->size();
+    Map *map = simulation.get_map();
+
+    auto integrate = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) agents[i].integrate(Simulation::FIXED_TIMESTEP);
+    };
+    auto collide = [&](int begin, int end) {
+        for (int i = begin; i < end; i++) agents[i].collide_with_map(Simulation::FIXED_TIMESTEP, map);
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    for (int step = 0; step < steps; step++)
+    {
+        perception.update(agents, agent_count, simulation.get_player(), map, jobs);
+        ai_machine.update(agents, agent_count, perception, jobs);
+
+        if (jobs != nullptr)
+        {
+            jobs->parallel_for(agent_count, Simulation::ENEMY_JOB_GRAIN, integrate);
+            jobs->parallel_for(agent_count, Simulation::ENEMY_JOB_GRAIN, collide);
+        }
+        else
+        {
+            integrate(0, agent_count);
+            collide(0, agent_count);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::milli>(end - start).count() / steps;
+}
+
+int main(int argc, char* argv[])
+{
+    int steps            = argc > 1 ? atoi(argv[1]) : DEFAULT_STEPS;
+    int threads          = argc > 2 ? atoi(argv[2]) : -1;
+    const char *ai_table = argc > 3 ? argv[3] : DEFAULT_AI_TABLE;
+    if (steps <= 0)
+    {
+        printf("usage: crowd_bench [steps] [threads] [ai_table]\n");
+        return 1;
+    }
+
+    Simulation simulation;
+    if (!simulation.initialise(ai_table)) return 1;
+
+    JobSystem jobs(threads < 0 ? -1 : threads - 1);
+    printf("%d steps per run, %d threads\n", steps, jobs.get_thread_count());
+    printf("%8s %14s %14s %8s  %s\n", "enemies", "serial ms/step", "jobs ms/step", "speedup", "checksum");
+
+    bool all_match = true;
+    for (int count : CROWD_SIZES)
+    {
+        std::vector<Entity> serial   = make_crowd(simulation, count),
+                            parallel = serial;
+
+        double serial_ms   = run(simulation, ai_table, &serial, steps, nullptr);
+        double parallel_ms = run(simulation, ai_table, &parallel, steps, &jobs);
+
+        unsigned int serial_checksum   = crowd_checksum(serial),
+                     parallel_checksum = crowd_checksum(parallel);
+        bool is_match = serial_checksum == parallel_checksum;
+        all_match = all_match && is_match;
+
+        printf("%8d %14.3f %14.3f %7.2fx  %08x %s\n", count, serial_ms, parallel_ms, serial_ms / parallel_ms,
+               serial_checksum, is_match ? "matched" : "MISMATCH");
+    }
+
+    return all_match ? 0 : 1;
+}
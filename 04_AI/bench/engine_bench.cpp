@@ -0,0 +1,319 @@
+//
+//  engine_bench.cpp
+//  04_AI
+//
+//  Microbenchmarks for the engine's hot paths, each run at a range of sizes:
+//  Map::is_solid, Map::build and reading a map by chunks, the entity-entity
+//  and entity-map collision checks, Entity::update, and the quads
+//  Utility::draw_text builds. Like Google Benchmark, each case is run for
+//  enough iterations to fill a minimum time and reported as time per
+//  iteration; --csv prints the same numbers as CSV, one row per case and size,
+//  so runs on two commits can be diffed.
+//
+//  Usage: engine_bench [--csv] [--filter substring] [--min-time seconds]
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "Entity.h"
+#include "Map.h"
+#include "Utility.h"
+
+// Runs the case's loop body the given number of times
+typedef std::function<void(long long iterations)> Loop;
+
+struct Case
+{
+    const char *name;
+    const char *item;                       // what one iteration does, for the table
+    std::vector<int> sizes;
+    std::function<Loop(int size)> setup;    // untimed; returns the timed loop
+};
+
+// Results are summed in here so that no loop can be optimised away
+volatile float g_sink = 0.0f;
+
+// ————— FIXTURES ————— //
+constexpr float TILE_SIZE = 1.0f;
+
+// A size by size map with about one tile in five solid, and a floor
+std::vector<unsigned int> random_level(int size, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::vector<unsigned int> level_data(size * size);
+    for (int y = 0; y < size; y++)
+        for (int x = 0; x < size; x++)
+            level_data[y * size + x] = (y == size - 1 || random() % 5 == 0) ? 1 + random() % 4 : 0;
+    return level_data;
+}
+
+// Points anywhere over the map, cycled through by the loops
+std::vector<glm::vec3> random_points(int size, int count, unsigned int seed)
+{
+    std::mt19937 random(seed);
+    std::uniform_real_distribution<float> coordinate(-0.5f, size - 0.5f);
+    std::vector<glm::vec3> points(count);
+    for (glm::vec3 &point : points) point = glm::vec3(coordinate(random), -coordinate(random), 0.0f);
+    return points;
+}
+
+constexpr int POINT_COUNT = 4096;           // a power of two, to wrap with a mask
+
+struct MapFixture
+{
+    std::vector<unsigned int> level_data;
+    std::unique_ptr<Map> map;
+    std::vector<glm::vec3> points;
+
+    MapFixture(int size) : level_data(random_level(size, 7)), points(random_points(size, POINT_COUNT, 11))
+    {
+        map.reset(new Map(size, size, level_data.data(), 0, TILE_SIZE, 4, 1));
+    }
+};
+
+// A player among count enemies spread over a screen or so around it, some of
+// them close enough to touch
+struct EntityFixture
+{
+    Entity player;
+    std::unique_ptr<Entity[]> enemies;
+    int enemy_count;
+
+    EntityFixture(int count) : player(0, 1.0f, 0.8f, 0.8f, PLAYER), enemies(new Entity[std::max(count, 0)]), enemy_count(count)
+    {
+        std::mt19937 random(3);
+        std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+        for (int i = 0; i < count; i++)
+        {
+            enemies[i] = Entity(0, 1.0f, 0.8f, 0.8f, ENEMY, WALKER, IDLE);
+            enemies[i].set_position(glm::vec3(offset(random), offset(random), 0.0f));
+        }
+    }
+
+    // Collisions move and stop the player, so each iteration starts it afresh.
+    // It is going up, which never knocks enemies out.
+    void reset_player(glm::vec3 position)
+    {
+        player.activate();
+        player.set_position(position);
+        player.set_velocity(glm::vec3(1.0f, 1.0f, 0.0f));
+    }
+};
+
+// ————— CASES ————— //
+std::vector<Case> make_cases()
+{
+    const std::vector<int> map_sizes = { 16, 64, 256, 1024 };
+    const std::vector<int> entity_counts = { 1, 8, 64, 512 };
+    std::vector<Case> cases;
+
+    cases.push_back({ "Map::is_solid", "probe", map_sizes, [](int size) -> Loop {
+        std::shared_ptr<MapFixture> fixture(new MapFixture(size));
+        return [fixture](long long iterations) {
+            float penetration_x, penetration_y, total = 0.0f;
+            for (long long i = 0; i < iterations; i++)
+                if (fixture->map->is_solid(fixture->points[i & (POINT_COUNT - 1)], &penetration_x, &penetration_y))
+                    total += penetration_x;
+            g_sink = g_sink + total;
+        };
+    }});
+
+    cases.push_back({ "Map::build", "map", map_sizes, [](int size) -> Loop {
+        std::shared_ptr<std::vector<unsigned int>> level_data(new std::vector<unsigned int>(random_level(size, 7)));
+        return [level_data, size](long long iterations) {
+            for (long long i = 0; i < iterations; i++)
+            {
+                Map map(size, size, level_data->data(), 0, TILE_SIZE, 4, 1);
+                g_sink = g_sink + map.get_right_bound();
+            }
+        };
+    }});
+
+    // What a minimap or a collision builder would do: read every tile in
+    // place, a 16 by 16 chunk at a time
+    cases.push_back({ "Map::for_each_chunk", "map", map_sizes, [](int size) -> Loop {
+        std::shared_ptr<MapFixture> fixture(new MapFixture(size));
+        return [fixture](long long iterations) {
+            long long solid = 0;
+            for (long long i = 0; i < iterations; i++)
+                fixture->map->for_each_chunk(16, 16, [&solid](const MapChunk &chunk) {
+                    for (int y = 0; y < chunk.get_height(); y++)
+                        for (unsigned int tile : chunk.get_row(y)) solid += tile != 0;
+                });
+            g_sink = g_sink + (float) solid;
+        };
+    }});
+
+    cases.push_back({ "Entity::check_collision", "pair", entity_counts, [](int count) -> Loop {
+        std::shared_ptr<EntityFixture> fixture(new EntityFixture(count));
+        return [fixture](long long iterations) {
+            int hits = 0;
+            for (long long i = 0; i < iterations; i++)
+                hits += fixture->player.check_collision(&fixture->enemies[i % fixture->enemy_count]);
+            g_sink = g_sink + hits;
+        };
+    }});
+
+    cases.push_back({ "Entity::check_collision_y(entities)", "sweep", entity_counts, [](int count) -> Loop {
+        std::shared_ptr<EntityFixture> fixture(new EntityFixture(count));
+        return [fixture](long long iterations) {
+            for (long long i = 0; i < iterations; i++)
+            {
+                fixture->reset_player(glm::vec3(0.0f));
+                fixture->player.check_collision_y(fixture->enemies.get(), fixture->enemy_count);
+            }
+            g_sink = g_sink + fixture->player.get_position().y;
+        };
+    }});
+
+    cases.push_back({ "Entity::check_collision_x(entities)", "sweep", entity_counts, [](int count) -> Loop {
+        std::shared_ptr<EntityFixture> fixture(new EntityFixture(count));
+        return [fixture](long long iterations) {
+            for (long long i = 0; i < iterations; i++)
+            {
+                fixture->reset_player(glm::vec3(0.0f));
+                fixture->player.check_collision_x(fixture->enemies.get(), fixture->enemy_count);
+            }
+            g_sink = g_sink + fixture->player.get_position().x;
+        };
+    }});
+
+    cases.push_back({ "Entity::check_collision_y(map)", "check", map_sizes, [](int size) -> Loop {
+        std::shared_ptr<MapFixture> map_fixture(new MapFixture(size));
+        std::shared_ptr<EntityFixture> fixture(new EntityFixture(1));
+        return [map_fixture, fixture](long long iterations) {
+            for (long long i = 0; i < iterations; i++)
+            {
+                fixture->reset_player(map_fixture->points[i & (POINT_COUNT - 1)]);
+                fixture->player.check_collision_y(map_fixture->map.get());
+            }
+            g_sink = g_sink + fixture->player.get_position().y;
+        };
+    }});
+
+    cases.push_back({ "Entity::check_collision_x(map)", "check", map_sizes, [](int size) -> Loop {
+        std::shared_ptr<MapFixture> map_fixture(new MapFixture(size));
+        std::shared_ptr<EntityFixture> fixture(new EntityFixture(1));
+        return [map_fixture, fixture](long long iterations) {
+            for (long long i = 0; i < iterations; i++)
+            {
+                fixture->reset_player(map_fixture->points[i & (POINT_COUNT - 1)]);
+                fixture->player.check_collision_x(map_fixture->map.get());
+            }
+            g_sink = g_sink + fixture->player.get_position().x;
+        };
+    }});
+
+    // The player's whole step: integrate, then map and enemy collisions on
+    // each axis, on a 64 by 64 map
+    cases.push_back({ "Entity::update", "step", entity_counts, [](int count) -> Loop {
+        std::shared_ptr<MapFixture> map_fixture(new MapFixture(64));
+        std::shared_ptr<EntityFixture> fixture(new EntityFixture(count));
+        return [map_fixture, fixture, count](long long iterations) {
+            Entity *player = &fixture->player;
+            for (long long i = 0; i < iterations; i++)
+            {
+                fixture->reset_player(map_fixture->points[i & (POINT_COUNT - 1)]);
+                player->update(1.0f / 60.0f, player, fixture->enemies.get(), count, map_fixture->map.get(), count);
+            }
+            g_sink = g_sink + player->get_position().x;
+        };
+    }});
+
+    // As draw_text does it: vectors in the frame arena, which a frame resets
+    cases.push_back({ "Utility::build_text_quads", "string", { 8, 32, 128, 512 }, [](int length) -> Loop {
+        std::shared_ptr<std::string> text(new std::string());
+        for (int i = 0; i < length; i++) *text += (char) ('A' + i % 26);
+        return [text](long long iterations) {
+            for (long long i = 0; i < iterations; i++)
+            {
+                {
+                    FrameVector<float> vertices, texture_coordinates;
+                    Utility::build_text_quads(text->c_str(), 0.5f, -0.05f, &vertices, &texture_coordinates);
+                    g_sink = g_sink + vertices.back();
+                }
+                FrameArena::frame().reset();
+            }
+        };
+    }});
+
+    return cases;
+}
+
+// ————— RUNNER ————— //
+double seconds_for(const Loop &loop, long long iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    loop(iterations);
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Grows the iteration count until a run takes a tenth of min_time, then
+// scales it up to fill min_time, as Google Benchmark does
+double ns_per_iteration(const Loop &loop, double min_time, long long *iterations)
+{
+    long long count = 1;
+    double seconds = seconds_for(loop, count);
+    while (seconds < min_time / 10.0 && count < (1LL << 40))
+    {
+        count *= 10;
+        seconds = seconds_for(loop, count);
+    }
+
+    if (seconds < min_time)
+    {
+        count = (long long) (count * min_time / (seconds > 0.0 ? seconds : 1e-9) * 1.1) + 1;
+        seconds = seconds_for(loop, count);
+    }
+
+    *iterations = count;
+    return seconds * 1e9 / count;
+}
+
+int main(int argc, char* argv[])
+{
+    bool is_csv = false;
+    const char *filter = "";
+    double min_time = 0.2;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--csv") == 0) is_csv = true;
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)   filter = argv[++i];
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) min_time = atof(argv[++i]);
+        else
+        {
+            fprintf(stderr, "Usage: engine_bench [--csv] [--filter substring] [--min-time seconds]\n");
+            return 1;
+        }
+    }
+
+    if (is_csv) printf("name,size,iterations,ns_per_iteration,iterations_per_second\n");
+    else        printf("%-38s %6s %12s %12s %12s\n", "case", "size", "iterations", "ns", "per second");
+
+    for (const Case &benchmark : make_cases())
+    {
+        if (!strstr(benchmark.name, filter)) continue;
+
+        for (int size : benchmark.sizes)
+        {
+            Loop loop = benchmark.setup(size);
+            long long iterations;
+            double ns = ns_per_iteration(loop, min_time, &iterations);
+
+            if (is_csv) printf("\"%s\",%d,%lld,%.3f,%.1f\n", benchmark.name, size, iterations, ns, 1e9 / ns);
+            else        printf("%-38s %6d %12lld %12.2f %12.4g %ss\n", benchmark.name, size, iterations, ns, 1e9 / ns, benchmark.item);
+            fflush(stdout);
+        }
+    }
+
+    return 0;
+}
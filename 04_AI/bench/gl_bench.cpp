@@ -0,0 +1,186 @@
+//
+//  gl_bench.cpp
+//  04_AI
+//
+//  Renders a recorded session against GLRecorder instead of a driver, so it
+//  needs no window, context or GPU, and reports what each frame asked of GL:
+//  draw calls, texture and program binds (and how many of those rebound what
+//  was already bound), uniform uploads and bytes uploaded, and what it
+//  allocated, by subsystem. It then checks the counts against a budget and
+//  exits with 1 if any is over, if GLRecorder caught a call that real GL
+//  would have rejected or ignored, or if the overlay's FrameStats counted a
+//  frame differently from GLRecorder.
+//
+//  Usage: gl_bench <recording> [--max-level-draws n] [--max-frame-draws n]
+//                              [--max-frame-allocations n]
+//
+//  The level (the tile map alone) may take 3 draw calls by default, and a
+//  whole frame one per entity plus the level. Allocations are only held to a
+//  budget when one is given, and only once the first WARM_UP_FRAMES are past.
+//  Run from 04_AI/04_AI so that shaders/ and assets/ resolve.
+//
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "FrameStats.h"
+#include "GLRecorder.h"
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "ShaderProgram.h"
+#include "Simulation.h"
+#include "Utility.h"
+
+constexpr char V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
+F_SHADER_PATH[] = "shaders/fragment_textured.glsl",
+AI_TABLE_FILEPATH[] = "assets/ai_machine.txt";
+
+constexpr int WARM_UP_FRAMES = 30;
+
+// ————— TOTALS ————— //
+struct Totals
+{
+    GLCounts sum, max;
+    int frames = 0;
+
+    // After the warm-up
+    long long tag_allocations[ALLOCATION_TAG_COUNT] = {};
+    long long max_allocations = 0;
+    int steady_frames = 0;
+
+    void add(const GLCounts &counts)
+    {
+        frames++;
+        sum.draw_calls      += counts.draw_calls;
+        sum.texture_binds   += counts.texture_binds;
+        sum.program_binds   += counts.program_binds;
+        sum.redundant_binds += counts.redundant_binds;
+        sum.uniform_uploads += counts.uniform_uploads;
+        sum.bytes_uploaded  += counts.bytes_uploaded;
+
+        max.draw_calls      = std::max(max.draw_calls, counts.draw_calls);
+        max.texture_binds   = std::max(max.texture_binds, counts.texture_binds);
+        max.program_binds   = std::max(max.program_binds, counts.program_binds);
+        max.redundant_binds = std::max(max.redundant_binds, counts.redundant_binds);
+        max.uniform_uploads = std::max(max.uniform_uploads, counts.uniform_uploads);
+        max.bytes_uploaded  = std::max(max.bytes_uploaded, counts.bytes_uploaded);
+    }
+
+    void add_heap(const FrameCounters &counters)
+    {
+        steady_frames++;
+        max_allocations = std::max(max_allocations, counters.allocations);
+        for (int tag = 0; tag < ALLOCATION_TAG_COUNT; tag++) tag_allocations[tag] += counters.tag_allocations[tag];
+    }
+
+    void print_row(const char *name, double total, double most) const
+    {
+        printf("  %-18s %10.1f %10.0f\n", name, frames ? total / frames : 0.0, most);
+    }
+};
+
+bool check(const char *what, long long value, long long budget)
+{
+    if (value <= budget) return true;
+    printf("OVER BUDGET: %s is %lld, at most %lld allowed\n", what, value, budget);
+    return false;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: gl_bench <recording> [--max-level-draws n] [--max-frame-draws n]\n");
+        return 1;
+    }
+
+    int max_level_draws = 3;
+    int max_frame_draws = Simulation::ENEMY_COUNT + 2;
+    int max_frame_allocations = -1;
+
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--max-level-draws") == 0)            max_level_draws = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--max-frame-draws") == 0)       max_frame_draws = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--max-frame-allocations") == 0) max_frame_allocations = atoi(argv[i + 1]);
+    }
+
+    InputRecording recording;
+    if (!recording.load(argv[1])) return 1;
+
+    GLRecorder::install();
+
+    // As main() sets it up
+    ShaderProgram program;
+    program.load(V_SHADER_PATH, F_SHADER_PATH);
+    program.set_projection_matrix(glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f));
+
+    SimulationTextures textures;
+    textures.tileset = Utility::load_texture("assets/winterTileSheet1.png");
+    textures.player  = Utility::load_texture("assets/rabbit.png");
+    textures.vulture = Utility::load_texture("assets/vulture1.png");
+    textures.fox     = Utility::load_texture("assets/fox.png");
+    textures.hunter  = Utility::load_texture("assets/hunter.png");
+    textures.bullet  = Utility::load_texture("assets/bullet.png");
+
+    JobSystem jobs;
+    Simulation simulation(&jobs);
+    if (!simulation.initialise(AI_TABLE_FILEPATH, textures)) return 1;
+
+    GLCounts loading = GLRecorder::end_frame();
+
+    // The level doesn't change, so once is enough
+    simulation.get_map()->render(&program);
+    GLCounts level = GLRecorder::end_frame();
+
+    Totals frames;
+    int miscounted_frames = 0;
+    FrameStats::end_frame();
+    for (int step = 0; step < recording.get_step_count() && simulation.get_result() == NONE; step++)
+    {
+        simulation.step(recording.get_input(step));
+        program.set_view_matrix(simulation.get_view_matrix());
+        simulation.render(&program);
+        FrameArena::frame().reset();
+        GLCounts counts = GLRecorder::end_frame();
+        frames.add(counts);
+
+        FrameCounters heap = FrameStats::end_frame();
+        if (step >= WARM_UP_FRAMES) frames.add_heap(heap);
+        if (heap.draw_calls != counts.draw_calls || heap.texture_binds != counts.texture_binds ||
+            heap.uniform_uploads != counts.uniform_uploads) miscounted_frames++;
+    }
+
+    printf("%s: %d frames\n", argv[1], frames.frames);
+    printf("loading:  %lld bytes uploaded\n", loading.bytes_uploaded);
+    printf("level:    %d draw calls, %lld vertices, %lld bytes uploaded\n", level.draw_calls, level.vertices, level.bytes_uploaded);
+    printf("per frame:               mean        max\n");
+    frames.print_row("draw calls", frames.sum.draw_calls, frames.max.draw_calls);
+    frames.print_row("texture binds", frames.sum.texture_binds, frames.max.texture_binds);
+    frames.print_row("program binds", frames.sum.program_binds, frames.max.program_binds);
+    frames.print_row("redundant binds", frames.sum.redundant_binds, frames.max.redundant_binds);
+    frames.print_row("uniform uploads", frames.sum.uniform_uploads, frames.max.uniform_uploads);
+    frames.print_row("bytes uploaded", (double) frames.sum.bytes_uploaded, (double) frames.max.bytes_uploaded);
+
+    if (frames.steady_frames > 0)
+    {
+        printf("allocations per frame after %d frames, by tag (most %lld):\n", WARM_UP_FRAMES, frames.max_allocations);
+        for (int tag = 0; tag < ALLOCATION_TAG_COUNT; tag++)
+            if (frames.tag_allocations[tag] > 0)
+                printf("  %-18s %10.1f\n", Allocations::get_tag_name((AllocationTag) tag),
+                       (double) frames.tag_allocations[tag] / frames.steady_frames);
+    }
+
+    const std::vector<std::string> &errors = GLRecorder::get_errors();
+    for (const std::string &error : errors) printf("GL ERROR: %s\n", error.c_str());
+
+    bool within_budget = check("level draw calls", level.draw_calls, max_level_draws);
+    within_budget &= check("frame draw calls", frames.max.draw_calls, max_frame_draws);
+    within_budget &= check("GL errors", errors.size(), 0);
+    within_budget &= check("frames FrameStats counted differently", miscounted_frames, 0);
+    if (max_frame_allocations >= 0) within_budget &= check("frame allocations", frames.max_allocations, max_frame_allocations);
+
+    GLRecorder::uninstall();
+    return within_budget ? 0 : 1;
+}
@@ -0,0 +1,65 @@
+//
+//  raycast_bench.cpp
+//  04_AI
+//
+//  Measures how many Map::raycast / line_of_sight_batch queries we sustain on
+//  a large random map. Usage: raycast_bench [map_size] [ray_count] [fill_percent]
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+#include "Map.h"
+
+int main(int argc, char* argv[])
+{
+    int map_size     = argc > 1 ? atoi(argv[1]) : 1024;
+    int ray_count    = argc > 2 ? atoi(argv[2]) : 1000000;
+    int fill_percent = argc > 3 ? atoi(argv[3]) : 10;
+
+    std::mt19937 random(1234);
+    std::uniform_int_distribution<int> percent(0, 99);
+    std::uniform_real_distribution<float> coordinate(0.0f, (float) map_size - 1.0f);
+    std::uniform_real_distribution<float> range(4.0f, 64.0f);
+
+    std::vector<unsigned int> level_data(map_size * map_size);
+    for (unsigned int &tile : level_data) tile = percent(random) < fill_percent ? 1 : 0;
+
+    Map map(map_size, map_size, level_data.data(), 0, 1.0f, 5, 4);
+
+    // Rays start anywhere and run a random distance in a random direction, like
+    // agents looking for a target somewhere nearby
+    std::vector<glm::vec3> origins(ray_count), directions(ray_count), targets(ray_count);
+    std::vector<float> max_distances(ray_count);
+    for (int i = 0; i < ray_count; i++)
+    {
+        origins[i]       = glm::vec3(coordinate(random), -coordinate(random), 0.0f);
+        float angle      = coordinate(random);
+        directions[i]    = glm::vec3(cosf(angle), sinf(angle), 0.0f);
+        max_distances[i] = range(random);
+        targets[i]       = origins[i] + directions[i] * max_distances[i];
+    }
+
+    std::vector<RaycastHit> hits(ray_count);
+    std::unique_ptr<bool[]> visible(new bool[ray_count]);
+
+    auto start = std::chrono::steady_clock::now();
+    map.raycast_batch(origins.data(), directions.data(), max_distances.data(), ray_count, hits.data());
+    auto middle = std::chrono::steady_clock::now();
+    map.line_of_sight_batch(origins.data(), targets.data(), ray_count, visible.get());
+    auto end = std::chrono::steady_clock::now();
+
+    int hit_count = 0;
+    for (const RaycastHit &hit : hits) hit_count += hit.hit ? 1 : 0;
+
+    double raycast_ms = std::chrono::duration<double, std::milli>(middle - start).count();
+    double sight_ms   = std::chrono::duration<double, std::milli>(end - middle).count();
+
+    printf("map %dx%d, %d%% solid, %d rays, %d hits\n", map_size, map_size, fill_percent, ray_count, hit_count);
+    printf("raycast_batch:       %9.2f ms  %10.0f rays/ms\n", raycast_ms, ray_count / raycast_ms);
+    printf("line_of_sight_batch: %9.2f ms  %10.0f rays/ms\n", sight_ms, ray_count / sight_ms);
+    return 0;
+}
@@ -0,0 +1,278 @@
+//
+//  render_bench.cpp
+//  04_AI
+//
+//  Renders a recorded session without a window or a GPU: an EGL surfaceless
+//  context (Mesa's llvmpipe on a machine without one) drawing into a
+//  framebuffer object the size of the game's window. Each frame steps the
+//  simulation once with the recorded input and draws it the way the game
+//  does, timing the CPU side of submitting the draws and the whole frame up to
+//  glFinish. --dump writes frames as PNGs, to compare against golden images.
+//
+//  Usage: render_bench <recording> [frames] [--dump directory] [--dump-every n]
+//
+//  frames defaults to 600. Once the recording runs out or the game is over,
+//  the last state keeps being drawn. Run from 04_AI/04_AI so that shaders/
+//  and assets/ resolve.
+//
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "FrameStats.h"
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "ShaderProgram.h"
+#include "Simulation.h"
+#include "Utility.h"
+
+constexpr int WIDTH = 640, HEIGHT = 480;
+
+constexpr char V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
+F_SHADER_PATH[] = "shaders/fragment_textured.glsl",
+AI_TABLE_FILEPATH[] = "assets/ai_machine.txt";
+
+// ————— CONTEXT ————— //
+// A desktop GL context with no surface at all, rendering into an FBO
+bool create_context(EGLDisplay *display, GLuint *framebuffer)
+{
+    PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+        (PFNEGLGETPLATFORMDISPLAYEXTPROC) eglGetProcAddress("eglGetPlatformDisplayEXT");
+    *display = get_platform_display ? get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr)
+                                    : eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+    EGLint major, minor;
+    if (*display == EGL_NO_DISPLAY || !eglInitialize(*display, &major, &minor) || !eglBindAPI(EGL_OPENGL_API))
+    {
+        printf("could not initialise EGL (error %#x)\n", eglGetError());
+        return false;
+    }
+
+    const EGLint config_attributes[] = { EGL_RENDERABLE_TYPE, EGL_OPENGL_BIT, EGL_NONE };
+    EGLConfig config = nullptr;
+    EGLint config_count = 0;
+    eglChooseConfig(*display, config_attributes, &config, 1, &config_count);
+
+    EGLContext context = eglCreateContext(*display, config_count > 0 ? config : nullptr, EGL_NO_CONTEXT, nullptr);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(*display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+    {
+        printf("could not create a surfaceless GL context (error %#x)\n", eglGetError());
+        return false;
+    }
+
+    GLuint colour;
+    glGenRenderbuffers(1, &colour);
+    glBindRenderbuffer(GL_RENDERBUFFER, colour);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, WIDTH, HEIGHT);
+
+    glGenFramebuffers(1, framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, *framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colour);
+    return glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+// ————— PNG ————— //
+// Uncompressed (stored) deflate blocks: larger files, but no zlib to link
+static unsigned int crc32(unsigned int crc, const unsigned char *bytes, size_t size)
+{
+    static unsigned int table[256];
+    if (table[1] == 0)
+        for (unsigned int n = 0; n < 256; n++)
+        {
+            unsigned int c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            table[n] = c;
+        }
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+static void put_u32(std::vector<unsigned char> *out, unsigned int value)
+{
+    for (int shift = 24; shift >= 0; shift -= 8) out->push_back((unsigned char) (value >> shift));
+}
+
+static void write_chunk(FILE *file, const char *type, const std::vector<unsigned char> &data)
+{
+    std::vector<unsigned char> chunk;
+    put_u32(&chunk, (unsigned int) data.size());
+    chunk.insert(chunk.end(), type, type + 4);
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put_u32(&chunk, crc32(0, chunk.data() + 4, chunk.size() - 4));
+    fwrite(chunk.data(), 1, chunk.size(), file);
+}
+
+// RGBA rows as glReadPixels gives them, bottom row first
+bool write_png(const char *filepath, const std::vector<unsigned char> &pixels, int width, int height)
+{
+    FILE *file = fopen(filepath, "wb");
+    if (!file) return false;
+
+    const unsigned char signature[] = { 137, 'P', 'N', 'G', '\r', '\n', 26, '\n' };
+    fwrite(signature, 1, sizeof(signature), file);
+
+    std::vector<unsigned char> header;
+    put_u32(&header, width);
+    put_u32(&header, height);
+    header.insert(header.end(), { 8, 6, 0, 0, 0 });     // 8-bit RGBA, no interlace
+    write_chunk(file, "IHDR", header);
+
+    // Each row starts with filter type 0, top row first
+    std::vector<unsigned char> raw;
+    const size_t row_size = (size_t) width * 4;
+    for (int y = height - 1; y >= 0; y--)
+    {
+        raw.push_back(0);
+        raw.insert(raw.end(), pixels.begin() + y * row_size, pixels.begin() + (y + 1) * row_size);
+    }
+
+    std::vector<unsigned char> zlib = { 0x78, 0x01 };
+    unsigned int a = 1, b = 0;
+    for (size_t offset = 0; offset < raw.size(); offset += 65535)
+    {
+        size_t size = std::min<size_t>(65535, raw.size() - offset);
+        zlib.push_back(offset + size == raw.size() ? 1 : 0);
+        zlib.insert(zlib.end(), { (unsigned char) size, (unsigned char) (size >> 8),
+                                  (unsigned char) ~size, (unsigned char) (~size >> 8) });
+        zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + size);
+    }
+    for (unsigned char byte : raw)
+    {
+        a = (a + byte) % 65521;
+        b = (b + a) % 65521;
+    }
+    put_u32(&zlib, (b << 16) | a);
+    write_chunk(file, "IDAT", zlib);
+    write_chunk(file, "IEND", std::vector<unsigned char>());
+
+    return fclose(file) == 0;
+}
+
+// ————— BENCH ————— //
+double percentile(std::vector<double> values, double fraction)
+{
+    if (values.empty()) return 0.0;
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, (size_t) (fraction * values.size()))];
+}
+
+double mean(const std::vector<double> &values)
+{
+    double total = 0.0;
+    for (double value : values) total += value;
+    return values.empty() ? 0.0 : total / values.size();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: render_bench <recording> [frames] [--dump directory] [--dump-every n]\n");
+        return 1;
+    }
+
+    const char *recording_filepath = argv[1];
+    int frame_count = 600;
+    const char *dump_directory = nullptr;
+    int dump_every = 1;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)            dump_directory = argv[++i];
+        else if (strcmp(argv[i], "--dump-every") == 0 && i + 1 < argc) dump_every = std::max(1, atoi(argv[++i]));
+        else frame_count = atoi(argv[i]);
+    }
+
+    InputRecording recording;
+    if (!recording.load(recording_filepath)) return 1;
+    if (frame_count <= 0) frame_count = 600;
+
+    EGLDisplay display;
+    GLuint framebuffer;
+    if (!create_context(&display, &framebuffer)) return 1;
+
+    // As main() sets it up
+    glViewport(0, 0, WIDTH, HEIGHT);
+    ShaderProgram program;
+    program.load(V_SHADER_PATH, F_SHADER_PATH);
+    program.set_projection_matrix(glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f));
+    glUseProgram(program.get_program_id());
+    glClearColor(0.1922f, 0.549f, 0.9059f, 1.0f);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    SimulationTextures textures;
+    textures.tileset = Utility::load_texture("assets/winterTileSheet1.png");
+    textures.player  = Utility::load_texture("assets/rabbit.png");
+    textures.vulture = Utility::load_texture("assets/vulture1.png");
+    textures.fox     = Utility::load_texture("assets/fox.png");
+    textures.hunter  = Utility::load_texture("assets/hunter.png");
+    textures.bullet  = Utility::load_texture("assets/bullet.png");
+
+    JobSystem jobs;
+    Simulation simulation(&jobs);
+    if (!simulation.initialise(AI_TABLE_FILEPATH, textures)) return 1;
+
+    std::vector<double> submit_ms, frame_ms;
+    std::vector<unsigned char> pixels(WIDTH * HEIGHT * 4);
+    int draw_calls = 0, dumped = 0;
+
+    auto draw = [&]() {
+        program.set_view_matrix(simulation.get_view_matrix());
+        glClear(GL_COLOR_BUFFER_BIT);
+        simulation.render(&program);
+        FrameArena::frame().reset();
+    };
+
+    // The first frame compiles llvmpipe's shaders; leave it out
+    draw();
+    glFinish();
+    FrameStats::end_frame();
+
+    for (int frame = 0; frame < frame_count; frame++)
+    {
+        if (frame < recording.get_step_count() && simulation.get_result() == NONE)
+            simulation.step(recording.get_input(frame));
+
+        auto start = std::chrono::steady_clock::now();
+        draw();
+        auto submitted = std::chrono::steady_clock::now();
+        glFinish();
+        auto finished = std::chrono::steady_clock::now();
+
+        submit_ms.push_back(std::chrono::duration<double, std::milli>(submitted - start).count());
+        frame_ms.push_back(std::chrono::duration<double, std::milli>(finished - start).count());
+        draw_calls += FrameStats::end_frame().draw_calls;
+
+        if (dump_directory && frame % dump_every == 0)
+        {
+            glReadPixels(0, 0, WIDTH, HEIGHT, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+            char filepath[512];
+            snprintf(filepath, sizeof(filepath), "%s/frame_%05d.png", dump_directory, frame);
+            if (!write_png(filepath, pixels, WIDTH, HEIGHT))
+            {
+                printf("could not write %s\n", filepath);
+                return 1;
+            }
+            dumped++;
+        }
+    }
+
+    int rendered = (int) frame_ms.size();
+    printf("%s: %d frames at %dx%d on %s\n", recording_filepath, rendered, WIDTH, HEIGHT, (const char *) glGetString(GL_RENDERER));
+    printf("submit:  %8.3f ms mean  %8.3f p50  %8.3f p99\n", mean(submit_ms), percentile(submit_ms, 0.5), percentile(submit_ms, 0.99));
+    printf("frame:   %8.3f ms mean  %8.3f p50  %8.3f p99  (%.0f frames/s)\n", mean(frame_ms), percentile(frame_ms, 0.5),
+           percentile(frame_ms, 0.99), 1000.0 / mean(frame_ms));
+    printf("draws:   %8.1f per frame\n", rendered ? (double) draw_calls / rendered : 0.0);
+    if (dump_directory) printf("dumped %d frames to %s\n", dumped, dump_directory);
+
+    eglTerminate(display);
+    return 0;
+}
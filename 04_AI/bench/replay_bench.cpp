@@ -0,0 +1,179 @@
+//
+//  replay_bench.cpp
+//  04_AI
+//
+//  Replays a recorded session through the headless Simulation, checks that it
+//  ends on the recorded checksum, and reports steps per second.
+//
+//  Usage: replay_bench <recording> [repeats] [ai_table]
+//         replay_bench --generate <recording> [steps] [seed] [ai_table]
+//
+//  --generate writes a scripted session (random walks, jumping whatever comes
+//  near) for when no real recording is at hand. Whenever the game ends, it
+//  backs up to a snapshot and plays that stretch again differently, so the
+//  session runs the full number of steps; it fails if it cannot. Run from
+//  04_AI/04_AI so that assets/ resolves.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "InputRecording.h"
+#include "JobSystem.h"
+#include "Simulation.h"
+
+constexpr char DEFAULT_AI_TABLE[] = "assets/ai_machine.txt";
+
+bool enemy_is_close(const Simulation &simulation)
+{
+    glm::vec3 player_position = simulation.get_player()->get_position();
+    for (int i = 0; i < Simulation::ENEMY_COUNT; i++)
+    {
+        const Entity &enemy = simulation.get_enemies()[i];
+        glm::vec3 offset = enemy.get_position() - player_position;
+        if (enemy.get_activation_status() && fabs(offset.x) < 1.5f && fabs(offset.y) < 1.0f) return true;
+    }
+    return false;
+}
+
+// How often generate() keeps a snapshot to back up to
+constexpr int CHECKPOINT_INTERVAL = 30;
+
+// Backing up further than this many checkpoints in a row means the bot is
+// stuck; give up rather than loop
+constexpr int MAX_REWINDS = 2000;
+
+int generate(const char *filepath, int step_count, unsigned int seed, const char *ai_table)
+{
+    JobSystem jobs;
+    Simulation simulation(&jobs);
+    if (!simulation.initialise(ai_table)) return 1;
+
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> hold_steps(10, 90);
+    std::uniform_int_distribution<int> direction(0, 2);
+    std::uniform_int_distribution<int> jump_chance(0, 99);
+
+    InputRecording recording;
+    unsigned char held = 0;
+    int hold_left = 0;
+
+    // checkpoints[i] is the state after i * CHECKPOINT_INTERVAL steps
+    std::vector<std::vector<unsigned char>> checkpoints(1);
+    simulation.save_state(&checkpoints[0]);
+
+    int rewinds = 0, furthest_step = 0, backoff = 0;
+
+    while (simulation.get_step_count() < step_count)
+    {
+        if (simulation.get_result() != NONE)
+        {
+            // The game ended, which would end the session: back up and play
+            // that stretch differently, further back each time it ends again
+            // before getting past where it ended the last time
+            if (++rewinds > MAX_REWINDS) break;
+            if (simulation.get_step_count() > furthest_step)
+            {
+                furthest_step = simulation.get_step_count();
+                backoff = 0;
+            }
+            int checkpoint = std::max(0, (simulation.get_step_count() - 1) / CHECKPOINT_INTERVAL - backoff++ / 4);
+
+            simulation.load_state(checkpoints[checkpoint]);
+            checkpoints.resize(checkpoint + 1);
+            recording.truncate(checkpoint * CHECKPOINT_INTERVAL);
+            hold_left = 0;
+            continue;
+        }
+
+        if (hold_left-- <= 0)
+        {
+            const unsigned char directions[] = { 0, INPUT_LEFT, INPUT_RIGHT };
+            held      = directions[direction(random)];
+            hold_left = hold_steps(random);
+        }
+
+        // Jump over anything that gets close, and now and then for no reason
+        unsigned char input = held;
+        if (jump_chance(random) < 3 || enemy_is_close(simulation)) input |= INPUT_JUMP;
+
+        recording.record(input);
+        simulation.step(input);
+
+        if (simulation.get_step_count() % CHECKPOINT_INTERVAL == 0 && simulation.get_result() == NONE)
+        {
+            checkpoints.emplace_back();
+            simulation.save_state(&checkpoints.back());
+        }
+    }
+
+    if (recording.get_step_count() < step_count)
+    {
+        printf("could only script %d of %d steps without the game ending (%d rewinds)\n",
+               recording.get_step_count(), step_count, rewinds);
+        return 1;
+    }
+
+    recording.set_final_checksum(simulation.checksum());
+    if (!recording.save(filepath)) return 1;
+
+    printf("wrote %d steps to %s (checksum %08x, %d rewinds)\n", recording.get_step_count(), filepath,
+           recording.get_final_checksum(), rewinds);
+    return 0;
+}
+
+int replay(const char *filepath, int repeats, const char *ai_table)
+{
+    InputRecording recording;
+    if (!recording.load(filepath)) return 1;
+
+    JobSystem jobs;
+    Simulation simulation(&jobs);
+
+    double total_ms = 0.0;
+    bool all_matched = true;
+
+    for (int run = 0; run < repeats; run++)
+    {
+        simulation.initialise(ai_table);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < recording.get_step_count(); step++)
+            simulation.step(recording.get_input(step));
+        auto end = std::chrono::steady_clock::now();
+
+        total_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        all_matched = all_matched && simulation.checksum() == recording.get_final_checksum();
+    }
+
+    double steps = (double) recording.get_step_count() * repeats;
+    printf("%s: %d steps x %d runs, %s\n", filepath, recording.get_step_count(), repeats,
+           all_matched ? "checksum matched" : "checksum DIVERGED");
+    printf("%9.2f ms  %12.0f steps/s\n", total_ms, steps / (total_ms / 1000.0));
+    return all_matched ? 0 : 2;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc > 2 && strcmp(argv[1], "--generate") == 0)
+    {
+        return generate(argv[2],
+                        argc > 3 ? atoi(argv[3]) : 36000,
+                        argc > 4 ? (unsigned int) atoi(argv[4]) : 1234,
+                        argc > 5 ? argv[5] : DEFAULT_AI_TABLE);
+    }
+
+    if (argc < 2)
+    {
+        printf("usage: replay_bench <recording> [repeats] [ai_table]\n"
+               "       replay_bench --generate <recording> [steps] [seed] [ai_table]\n");
+        return 1;
+    }
+
+    return replay(argv[1], argc > 2 ? atoi(argv[2]) : 10, argc > 3 ? argv[3] : DEFAULT_AI_TABLE);
+}
@@ -0,0 +1,123 @@
+//
+//  snapshot_bench.cpp
+//  04_AI
+//
+//  Replays a recorded session while keeping a SnapshotHistory of every step,
+//  then reports what the history costs (bytes per snapshot, time per push and
+//  per restore), checks that rewinding and replaying the tail lands on the
+//  recorded checksum, and bisects the history for the first step on which an
+//  enemy was down.
+//
+//  Usage: snapshot_bench <recording> [capacity] [keyframe_interval] [ai_table]
+//  Run from 04_AI/04_AI so that assets/ resolves.
+//
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include "InputRecording.h"
+#include "Simulation.h"
+#include "Snapshot.h"
+
+constexpr char DEFAULT_AI_TABLE[] = "assets/ai_machine.txt";
+
+// Binary search over the retained steps for the first one where condition
+// holds, assuming it keeps holding once it does. Returns -1 if it never does.
+int first_step_where(const SnapshotHistory &history, Simulation *simulation,
+                     const std::function<bool(const Simulation &)> &condition, int *restores)
+{
+    std::vector<unsigned char> snapshot;
+    int low = history.get_oldest_step(), high = history.get_newest_step(), found = -1;
+
+    while (low <= high)
+    {
+        int middle = low + (high - low) / 2;
+        history.get(middle, &snapshot);
+        simulation->load_state(snapshot);
+        (*restores)++;
+
+        if (condition(*simulation))
+        {
+            found = middle;
+            high  = middle - 1;
+        }
+        else low = middle + 1;
+    }
+    return found;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        printf("usage: snapshot_bench <recording> [capacity] [keyframe_interval] [ai_table]\n");
+        return 1;
+    }
+
+    InputRecording recording;
+    if (!recording.load(argv[1])) return 1;
+
+    int capacity          = argc > 2 ? atoi(argv[2]) : SnapshotHistory::DEFAULT_CAPACITY;
+    int keyframe_interval = argc > 3 ? atoi(argv[3]) : SnapshotHistory::DEFAULT_KEYFRAME_INTERVAL;
+    const char *ai_table  = argc > 4 ? argv[4] : DEFAULT_AI_TABLE;
+
+    Simulation simulation;
+    simulation.initialise(ai_table);
+
+    SnapshotHistory history(capacity, keyframe_interval);
+    std::vector<unsigned char> snapshot;
+    double push_ms = 0.0;
+
+    // ————— RECORD ————— //
+    simulation.save_state(&snapshot);
+    history.push(simulation.get_step_count(), snapshot);
+
+    for (int step = 0; step < recording.get_step_count(); step++)
+    {
+        simulation.step(recording.get_input(step));
+
+        auto start = std::chrono::steady_clock::now();
+        simulation.save_state(&snapshot);
+        history.push(simulation.get_step_count(), snapshot);
+        push_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+    unsigned int final_checksum = simulation.checksum();
+
+    printf("%s: %d steps, history holds steps %d-%d\n", argv[1], recording.get_step_count(),
+           history.get_oldest_step(), history.get_newest_step());
+    printf("snapshot:  %zu bytes whole, %.1f bytes stored on average (keyframe every %d)\n",
+           snapshot.size(), (double) history.get_stored_bytes() / history.get_count(), keyframe_interval);
+    printf("history:   %zu bytes stored for %zu bytes of snapshots (%.1fx)\n",
+           history.get_stored_bytes(), history.get_raw_bytes(),
+           (double) history.get_raw_bytes() / (double) history.get_stored_bytes());
+    printf("push:      %.3f us per step\n", 1000.0 * push_ms / (recording.get_step_count() + 1));
+
+    // ————— REWIND AND BRANCH ————— //
+    // Go back to the oldest held step and replay the tail; it has to end up
+    // exactly where the straight run did
+    int rewind_step = history.get_oldest_step();
+    auto start = std::chrono::steady_clock::now();
+    history.get(rewind_step, &snapshot);
+    bool loaded = simulation.load_state(snapshot);
+    double restore_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    for (int step = rewind_step; step < recording.get_step_count(); step++)
+        simulation.step(recording.get_input(step));
+
+    bool matched = loaded && simulation.checksum() == final_checksum && final_checksum == recording.get_final_checksum();
+    printf("rewind:    to step %d in %.3f us, replayed tail %s\n", rewind_step, 1000.0 * restore_ms,
+           matched ? "matched" : "DIVERGED");
+
+    // ————— BISECT ————— //
+    int restores = 0;
+    int first_down = first_step_where(history, &simulation, [](const Simulation &state) {
+        return state.get_current_enemy_count() < Simulation::ENEMY_COUNT ||
+               !state.get_player()->get_activation_status();
+    }, &restores);
+
+    if (first_down >= 0) printf("bisect:    first step with a casualty is %d (%d restores)\n", first_down, restores);
+    else printf("bisect:    no casualties in the held steps (%d restores)\n", restores);
+
+    return matched ? 0 : 2;
+}
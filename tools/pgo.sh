@@ -0,0 +1,149 @@
+#!/bin/sh
+#
+#  pgo.sh
+#
+#  Profile-guided build of the headless targets, trained on real play:
+#    1. a plain optimised build, to compare against;
+#    2. an instrumented build (CS3113_PGO=GENERATE) that replays a recorded
+#       04_AI session and plays seeded Pong games to write profiles;
+#    3. the same build directory rebuilt with those profiles (CS3113_PGO=USE).
+#  Then runs the same workloads on both builds and prints steps per second
+#  before and after, and, where EGL is available, the offscreen render's
+#  submission and frame times for the same session.
+#
+#  Usage: tools/pgo.sh [build_root] [04_AI_recording]
+#
+#  Without a recording, replay_bench --generate scripts one. Extra CMake
+#  arguments (a toolchain, -DSDL2_INCLUDE_DIR=...) can be passed in
+#  CMAKE_ARGS. Run from the repository root.
+#
+
+set -eu
+
+ROOT=$(pwd)
+OUT=${1:-build-pgo}
+case $OUT in /*) ;; *) OUT=$ROOT/$OUT ;; esac
+RECORDING=${2:-}
+case $RECORDING in ""|/*) ;; *) RECORDING=$ROOT/$RECORDING ;; esac
+JOBS=$(nproc 2>/dev/null || echo 4)
+RUNS=3                      # best of, for each measurement
+SESSION_STEPS=20000         # what gets scripted when no recording is given
+MIN_SESSION_STEPS=5000      # shorter sessions are too quick to time
+
+BASELINE=$OUT/baseline
+TRAINED=$OUT/trained
+PROFILES=$OUT/profiles
+
+configure() {
+    # shellcheck disable=SC2086
+    cmake -S "$ROOT" -B "$1" -DCMAKE_BUILD_TYPE=Release -DCS3113_NATIVE=ON -DCS3113_GAMES=OFF \
+          -DCS3113_PGO_DIR="$PROFILES" ${CMAKE_ARGS:-} "$@" > /dev/null
+}
+
+# Compiler output goes to a log beside the build, shown only if it fails
+build() {
+    mkdir -p "$1"
+    cmake --build "$1" -j "$JOBS" --clean-first > "$1/build.log" 2>&1 || { cat "$1/build.log"; exit 1; }
+}
+
+has_ai() {
+    [ -x "$1/bench/replay_bench" ]
+}
+
+# The workloads, run from 04_AI/04_AI so that its assets resolve
+ai_steps_per_second() {
+    (cd "$ROOT/04_AI/04_AI" && "$1/bench/replay_bench" "$RECORDING" 5) | awk '/steps\/s/ { print $(NF - 1) }'
+}
+
+# Mean milliseconds; $2 picks the submit: or frame: line
+render_ms() {
+    (cd "$ROOT/04_AI/04_AI" && "$1/bench/render_bench" "$RECORDING" 600) | awk -v line="$2:" '$1 == line { print $2 }'
+}
+
+# Lower is better, so the best of several runs is the smallest
+best_ms_of() {
+    best=
+    for _ in $(seq "$RUNS"); do
+        ms=$("$@")
+        best=$(awk -v a="$best" -v b="$ms" 'BEGIN { print (a == "" || b < a) ? b : a }')
+    done
+    echo "$best"
+}
+
+pong_steps_per_second() {
+    "$1/bench/sim_bench" 2000 | awk '/steps per second/ { print $5 }'
+}
+
+train() {
+    if has_ai "$1"; then
+        (cd "$ROOT/04_AI/04_AI" && "$1/bench/replay_bench" "$RECORDING" 5 > /dev/null)
+        (cd "$ROOT/04_AI/04_AI" && "$1/bench/snapshot_bench" "$RECORDING" > /dev/null)
+    fi
+    "$1/bench/sim_bench" 2000 > /dev/null
+    "$1/bench/rollback_bench" > /dev/null
+}
+
+best_of() {
+    best=0
+    for _ in $(seq "$RUNS"); do
+        rate=$("$@")
+        best=$(awk -v a="$best" -v b="$rate" 'BEGIN { print (b > a) ? b : a }')
+    done
+    echo "$best"
+}
+
+report() {
+    awk -v name="$1" -v before="$2" -v after="$3" \
+        'BEGIN { printf "%-22s %14.6g %14.6g %+8.1f%%\n", name, before, after, 100 * (after / before - 1) }'
+}
+
+echo "baseline build"
+configure "$BASELINE" -DCS3113_PGO=OFF
+build "$BASELINE"
+
+if has_ai "$BASELINE"; then
+    if [ -z "$RECORDING" ]; then
+        RECORDING=$OUT/session.rec
+        (cd "$ROOT/04_AI/04_AI" && "$BASELINE/bench/replay_bench" --generate "$RECORDING" "$SESSION_STEPS" > /dev/null)
+    fi
+
+    # A session that ended early would train and time next to nothing
+    steps=$(cd "$ROOT/04_AI/04_AI" && "$BASELINE/bench/replay_bench" "$RECORDING" 1 | awk 'NR == 1 { print $2 }')
+    if [ "${steps:-0}" -lt "$MIN_SESSION_STEPS" ]; then
+        echo "$RECORDING has ${steps:-no} steps; at least $MIN_SESSION_STEPS are needed" >&2
+        exit 1
+    fi
+    echo "04_AI session: $steps steps"
+fi
+
+echo "instrumented build"
+rm -rf "$PROFILES"
+configure "$TRAINED" -DCS3113_PGO=GENERATE
+build "$TRAINED"
+
+echo "training"
+train "$TRAINED"
+
+# Clang writes raw profiles that have to be merged first; GCC's are read as
+# they are
+if ls "$PROFILES"/*.profraw > /dev/null 2>&1; then
+    llvm-profdata merge -output="$PROFILES/default.profdata" "$PROFILES"/*.profraw
+fi
+
+echo "optimised build"
+configure "$TRAINED" -DCS3113_PGO=USE
+build "$TRAINED"
+
+echo
+printf "%-22s %14s %14s %9s\n" "workload" "before" "after" "change"
+if has_ai "$BASELINE"; then
+    report "04_AI replay steps/s" "$(best_of ai_steps_per_second "$BASELINE")" "$(best_of ai_steps_per_second "$TRAINED")"
+else
+    echo "(04_AI skipped: its targets need the SDL2 headers)"
+fi
+report "Pong games steps/s" "$(best_of pong_steps_per_second "$BASELINE")" "$(best_of pong_steps_per_second "$TRAINED")"
+
+if [ -x "$BASELINE/bench/render_bench" ]; then
+    report "offscreen submit ms" "$(best_ms_of render_ms "$BASELINE" submit)" "$(best_ms_of render_ms "$TRAINED" submit)"
+    report "offscreen frame ms" "$(best_ms_of render_ms "$BASELINE" frame)" "$(best_ms_of render_ms "$TRAINED" frame)"
+fi